@@ -1,87 +1,349 @@
+#include <charconv>
+#include <chrono>
 #include <iostream>
 #include <filesystem>
-#include <generator>
-#include <queue>
-
-bool is_direct_child_path_of(std::filesystem::path const &possible_child_path, std::filesystem::path const &known_path) {
-
-    namespace fs = std::filesystem;
-    auto cpath{ fs::canonical(possible_child_path) }; 
-    // cpath is constructed by fs::canonical which converts a path into its absolute, normalized, symlink resolved form,
-    //      so path comparisons reflect the real filesystem
-
-    // consider a path that does not have a parent path to be under known_path... 
-    if (not cpath.has_parent_path()) // basically if cpath doesnt have a parent, then it is the root
-        return true;
-    auto parent_cpath{ cpath.parent_path() };
-    // otherwise ensure possible_child_path's parent path is known_path
-    // and use canonical() to determine this...
-    auto known_canonical_path{ fs::canonical(known_path) };
-    return parent_cpath == known_canonical_path;
-}
+#include <string>
+#include <string_view>
+#include <system_error>
 
-std::generator<std::filesystem::path> bfs_scan(std::filesystem::path root_path) { // take root path as input from argv[i] (initial path we look at)
-    std::queue<std::filesystem::path> path_chain; // declaring queue of respective type
-    path_chain.push(root_path);                   // push root/current path onto queue
+#include "bfs_scan.hpp"
+#include "incremental_scan.hpp"
+#include "metadata_scan.hpp"
+#include "output_writer.hpp"
+#include "parallel_scan.hpp"
+#include "watch_scan.hpp"
 
-    while (!path_chain.empty()) {        // while paths still exist
-        auto cur = path_chain.front();   // get first element of queue
-        path_chain.pop();                // pop the oldest item aka top of queue
+// parses all of s as a number (with std::from_chars so no spaces, suffixes or leading +)...
+template <typename T>
+bool parse_number(std::string_view s, T& value) {
+    auto const [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    return ec == std::errc{} && end == s.data() + s.size();
+}
 
-        for (auto const& directory_entry : std::filesystem::directory_iterator{cur})  {
+int main (int argc, char* argv[]){
+    using namespace std;
 
-            // If current entry is a symbolic link and still points to a child directory under our current parent directory --> cur
-            
-            if(directory_entry.is_symlink()){
-                // Try Catch since canonical was giving filesystem error for symlink "link3" which was a file not a directory
-                try {
-                    if (is_direct_child_path_of(directory_entry.path(), cur)){
-                        co_yield directory_entry.path(); // Then co_yield entry path() so we return path then resume
-                    }
-                }
-                catch (const std::exception& e) {
-                    // ignore this file and move on
+    // options come before the paths:
+    //   -j N  scan with N threads (0 = one per core), see parallel_scan.hpp
+    //   -u    (only with -j) output files as soon as they are found instead of in BFS order
+    //   -g    read directories with getdents64() instead of directory_iterator (Linux), see dirent_reader.hpp
+    //   -T ORDER  (can't be used with -j or -l) the order directories are read in, see scan_frontier.hpp: bfs (the default),
+    //             dfs (only the subdirectories of the directories on the current path are pending, so
+    //             that is as much as it holds) or hybrid[=BYTES] (bfs until the pending directories take
+    //             more than BYTES, default 64 MiB, then dfs until they are down to half; it can still go
+    //             over BYTES by the subdirectories along the current path)
+    //   -i FILE  incremental: only output what changed since the last -i FILE scan of the same PATH, as
+    //            + "path" (added) and - "path" (removed) lines, reading only the directories that changed.
+    //            FILE keeps a snapshot of each PATH's directories (see incremental_scan.hpp). Can't be used
+    //            with the filters, -l, -j, -g or -T.
+    //   -w       watch: output every path as + "path" and then keep outputting changes as they happen,
+    //            + (created), - (deleted), < (moved from) and > (moved to), until PATH is deleted or
+    //            the program is stopped. Uses inotify on Linux, see watch_scan.hpp. Only one PATH and
+    //            can't be used with -i, the filters, -l, -j, -g or -T.
+    //   -0    end each path with a NUL instead of a newline and don't quote it (for xargs -0, like find -print0)
+    //   -r    output paths raw, i.e., without the quotes (and escapes) std::cout << path adds
+    //   -l    also output each file's size and last write time (seconds since the epoch), the files are
+    //         stat'ed in batches with io_uring (Linux) or a thread pool of -j threads, see metadata_scan.hpp.
+    //         Always in BFS order and reads directories its own way, so can't be used with -g, -u or -T.
+    // filters (see scan_filter.hpp), applied while scanning so excluded directories are never read:
+    //   -x GLOB  skip directories and files whose name matches GLOB, e.g., -x .git -x node_modules (repeatable)
+    //   -d N     only output entries up to N levels below PATH
+    //   -X       don't descend into directories on other filesystems
+    //   -e EXT   only output files with extension EXT, e.g., -e cpp (repeatable)
+    //   -s MIN   only output files of at least MIN bytes
+    //   -S MAX   only output files of at most MAX bytes
+    //   -t DAYS  only output files modified in the last DAYS days
+    parallel_scan_options popts;
+    bool parallel = false;
+    string_view order = "bfs";
+    size_t order_budget = hybrid_frontier::default_byte_budget;
+    bool long_listing = false;
+    char const* snapshot_file = nullptr;
+    bool watch = false;
+    path_format format = path_format::quoted;
+    char terminator = '\n';
+    int first_path = 1;
+    string_view bad_option;   // the option whose value is missing or bad
+    for (; first_path < argc && argv[first_path][0] == '-'; ++first_path) {
+        string_view const opt{ argv[first_path] };
+        // the value of an option that takes one (nullptr if it is missing)...
+        auto next_arg = [&]() -> char const* {
+            return first_path + 1 < argc ? argv[++first_path] : nullptr;
+        };
+        // parses the value of an option that takes a number...
+        auto next_number = [&](auto& value) {
+            auto const arg = next_arg();
+            return arg && parse_number(arg, value);
+        };
+        if (opt == "-j") {
+            if (!next_number(popts.threads)) {
+                bad_option = opt;
+                break;
+            }
+            parallel = true;
+        }
+        else if (opt == "-u")
+            popts.ordered = false;
+        else if (opt == "-g")
+            popts.backend = scan_backend::getdents;
+        else if (opt == "-T") {
+            auto const arg = next_arg();
+            if (!arg) {
+                bad_option = opt;
+                break;
+            }
+            order = arg;
+            if (order.starts_with("hybrid=")) {
+                if (!parse_number(order.substr(7), order_budget)) {
+                    bad_option = opt;
+                    break;
                 }
+                order = "hybrid";
             }
-             else if (!directory_entry.is_symlink() && directory_entry.status().type() == std::filesystem::file_type::directory){ // if true directory
-                path_chain.push(directory_entry);
-                    
-            } else if (directory_entry.status().type() == std::filesystem::file_type::regular){
-                co_yield directory_entry.path();
+        }
+        else if (opt == "-l")
+            long_listing = true;
+        else if (opt == "-i") {
+            if (!(snapshot_file = next_arg())) {
+                bad_option = opt;
+                break;
+            }
+        }
+        else if (opt == "-w")
+            watch = true;
+        else if (opt == "-0") {
+            format = path_format::raw;
+            terminator = '\0';
+        }
+        else if (opt == "-r")
+            format = path_format::raw;
+        else if (opt == "-x") {
+            auto const glob = next_arg();
+            if (!glob) {
+                bad_option = opt;
+                break;
+            }
+            popts.filter.exclude.emplace_back(glob);
+        }
+        else if (opt == "-d") {
+            size_t depth;
+            if (!next_number(depth)) {
+                bad_option = opt;
+                break;
+            }
+            popts.filter.max_depth = depth;
+        }
+        else if (opt == "-X")
+            popts.filter.same_filesystem = true;
+        else if (opt == "-e") {
+            auto const arg = next_arg();
+            if (!arg) {
+                bad_option = opt;
+                break;
+            }
+            string ext{ arg };
+            if (!ext.starts_with('.'))
+                ext.insert(ext.begin(), '.');
+            popts.filter.extensions.push_back(std::move(ext));
+        }
+        else if (opt == "-s" || opt == "-S") {
+            uintmax_t size;
+            if (!next_number(size)) {
+                bad_option = opt;
+                break;
             }
+            (opt == "-s" ? popts.filter.min_size : popts.filter.max_size) = size;
         }
-        
+        else if (opt == "-t") {
+            using file_duration = filesystem::file_time_type::duration;
+            long long days;
+            if (!next_number(days) || days < 0 || days > file_duration::max() / chrono::hours(24)) {
+                bad_option = opt;
+                break;
+            }
+            // (a time before file_time_type::min() can't be represented so that is as far back as it goes)
+            auto const now = filesystem::file_time_type::clock::now();
+            auto const age = chrono::duration_cast<file_duration>(chrono::hours(24) * days);
+            popts.filter.newer_than = now.time_since_epoch() < file_duration::min() + age ? filesystem::file_time_type::min() : now - age;
+        }
+        else
+            break;
     }
-    co_return; // end of generator
-} 
 
+    auto usage = [&] {
+        cerr << "Usage: " << argv[0] << " [-g] [-T ORDER] [-0] [-r] [-l] [-i FILE] [-w] [-j THREADS [-u]] [-x GLOB] [-d N] [-X] [-e EXT] [-s MIN] [-S MAX] [-t DAYS] PATH [PATH]... \n\n";
+    };
 
-int main (int argc, char* argv[]){
-    using namespace std;
-    if (argc <= 1) {
+    if (!bad_option.empty()) {
+        cerr << "\nMissing or bad value for option " << bad_option << ".\n";
+        usage();
+        return 1;
+    }
+
+    if (watch && first_path + 1 < argc) {
+        cerr << "\n-w watches one PATH.\n\n";
+        return 1;
+    }
+
+    // watch_bfs_scan() reports every change under PATH (see watch_scan.hpp)...
+    if (watch && (snapshot_file || popts.filter.active() || long_listing || parallel || popts.backend != scan_backend::iterator || order != "bfs")) {
+        cerr << "\n-w can't be used with -i, -x, -d, -X, -e, -s, -S, -t, -l, -j, -g or -T.\n\n";
+        return 1;
+    }
+
+    // incremental_bfs_scan() diffs against a snapshot of the whole tree so it can't filter, and it
+    // has its own way of reading directories...
+    if (snapshot_file && (popts.filter.active() || long_listing || parallel || popts.backend != scan_backend::iterator || order != "bfs")) {
+        cerr << "\n-i can't be used with -x, -d, -X, -e, -s, -S, -t, -l, -j, -g or -T.\n\n";
+        return 1;
+    }
+
+    if (order != "bfs" && order != "dfs" && order != "hybrid") {
+        cerr << "\n-T takes bfs, dfs or hybrid[=BYTES].\n\n";
+        return 1;
+    }
+
+    // only parallel_bfs_scan() has an unordered mode...
+    if (!popts.ordered && !parallel) {
+        cerr << "\n-u can only be used with -j.\n\n";
+        return 1;
+    }
+
+    // metadata_bfs_scan() picks its own directory reader and always outputs in BFS order...
+    if (long_listing && (popts.backend != scan_backend::iterator || !popts.ordered || order != "bfs")) {
+        cerr << "\n-l can't be used with -g, -u or -T.\n\n";
+        return 1;
+    }
+
+    // parallel_bfs_scan() and metadata_bfs_scan() always go breadth first...
+    if (order != "bfs" && (parallel || long_listing)) {
+        cerr << "\n-T can't be used with -j or -l.\n\n";
+        return 1;
+    }
+
+    if (first_path >= argc) {
         cerr << "\nNo detected arguments passed to program, please pass args.\n";
-        cerr << "Usage: " << argv[0] << " PATH [PATH]... \n\n";
+        usage();
         return 1;
     }
     else {
-        for (int i = 1; i < argc; ++i){
+        scan_snapshots snapshots;
+        if (snapshot_file) {
+            try {
+                snapshots = load_snapshots(snapshot_file);
+            }
+            catch (const exception& e) {
+                cerr << "EXCEPTION: " << e.what() << '\n';
+                return 1;
+            }
+        }
+
+        // all of the paths go through out (see output_writer.hpp) which must be flushed before anything
+        // is written to cerr so the two stay in order when they go to the same place...
+        output_writer out{ 1, format, terminator };
+        auto flush_output = [&out] {
+            try {
+                out.flush();
+            }
+            catch (const exception& e) {
+            }
+        };
+
+        // the single threaded scanners with the frontier -T picked (see scan_frontier.hpp)...
+        auto sequential_scan = [&](char const* root) -> generator<filesystem::path> {
+            bool const getdents = popts.backend == scan_backend::getdents;
+            if (order == "dfs")
+                return getdents ? getdents_bfs_scan<dfs_frontier>(root, popts.filter) : bfs_scan<dfs_frontier>(root, popts.filter);
+            if (order == "hybrid") {
+                hybrid_frontier const frontier{ order_budget };
+                return getdents ? getdents_bfs_scan(root, popts.filter, frontier) : bfs_scan(root, popts.filter, frontier);
+            }
+            return getdents ? getdents_bfs_scan(root, popts.filter) : bfs_scan(root, popts.filter);
+        };
+
+        for (int i = first_path; i < argc; ++i){
             try {
+                if (watch) {
+                    auto generator = watch_bfs_scan(argv[i]);
+                    cerr << "Processing path " << argv[i] << "\n";
+                    for (auto const& [kind, file] : generator) {
+                        out.write(change_prefix(kind));
+                        out.write_path(file);
+                        out.end_record();
+                        out.flush();   // flushed since the changes trickle in
+                    }
+                    continue;
+                }
+
+                if (snapshot_file) {
+                    auto const found = snapshots.find(argv[i]);
+                    scan_snapshot next;
+                    auto generator = incremental_bfs_scan(argv[i], found != snapshots.end() ? &found->second : nullptr, next);
+                    out.flush();
+                    cerr << "Processing path " << argv[i] << "\n";
+                    for (auto const& [kind, file] : generator) {
+                        out.write(change_prefix(kind));
+                        out.write_path(file);
+                        out.end_record();
+                    }
+                    // only a scan that finished replaces the path's snapshot...
+                    snapshots[argv[i]] = std::move(next);
+                    continue;
+                }
+
+                if (long_listing) {
+                    metadata_scan_options mopts;
+                    mopts.threads = popts.threads;
+                    mopts.filter = popts.filter;
+                    auto generator = metadata_bfs_scan(argv[i], mopts);
+                    out.flush();
+                    cerr << "Processing path " << argv[i] << "\n";
+                    for (auto const& [file, metadata] : generator) {
+                        out.write_path(file);
+                        if (metadata.error)
+                            out.write(" ? ?");
+                        else {
+                            out.put(' ');
+                            out.write(metadata.size);
+                            out.put(' ');
+                            out.write(chrono::floor<chrono::seconds>(chrono::file_clock::to_sys(metadata.mtime)).time_since_epoch().count());
+                        }
+                        out.end_record();
+                    }
+                    continue;
+                }
+
                 //Call bfs_scan() passing the current argv[i] value (i.e., the current path from the command line) to it.
                 //Output "Processing path " followed by the path (i.e., argv[i]) being processed followed by a newline to std::cerr.
-                auto generator = bfs_scan(argv[i]);
+                auto generator = parallel ? parallel_bfs_scan(argv[i], popts) : sequential_scan(argv[i]);
+                out.flush();
                 cerr << "Processing path " << argv[i] << "\n";
-                for (auto const& file: generator) { // iterate over elements(files or symlinks) saved in coroutine and output to cout
-                    cout << file << "\n";
+                for (auto const& file: generator) { // iterate over elements(files or symlinks) saved in coroutine and output through out
+                    out.write_path(file);
+                    out.end_record();
                 }
             }
             catch(std::filesystem::filesystem_error const& e){
+                flush_output();
                 cerr << "EXCEPTION: path: " << argv[i] << ", reason: " << e.what() << '\n';
             }
             catch(const exception& e){
+                flush_output();
                 cerr << "EXCEPTION: Unknown exception.";
             }
         }
+        flush_output();
+
+        if (snapshot_file) {
+            try {
+                save_snapshots(snapshot_file, snapshots);
+            }
+            catch (const exception& e) {
+                cerr << "EXCEPTION: " << e.what() << '\n';
+                return 1;
+            }
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,116 @@
+#ifndef include_bfs_scan_hpp_
+#define include_bfs_scan_hpp_
+
+#include <exception>
+#include <filesystem>
+#include <generator>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "dirent_reader.hpp"
+#include "path_arena.hpp"
+#include "scan_entry.hpp"
+#include "scan_filter.hpp"
+#include "scan_frontier.hpp"
+
+// filter (see scan_filter.hpp) is applied as the directory is read, so pruned directories are never opened.
+// Frontier picks the traversal order (see scan_frontier.hpp), e.g., bfs_scan<dfs_frontier>(root), and
+// defaults to breadth first...
+template <scan_frontier_c Frontier = bfs_frontier>
+inline std::generator<std::filesystem::path> bfs_scan(std::filesystem::path root_path, scan_filter filter = {}, Frontier path_chain = {}) { // take root path as input from argv[i] (initial path we look at)
+    // path_chain holds (directory, its depth) with root at depth 0
+    path_chain.push(root_path, 0);                                        // push root/current path onto queue
+    auto const root_dev = filter.root_device(root_path);
+
+    while (!path_chain.empty()) {                    // while paths still exist
+        auto [cur, depth] = path_chain.pop();        // pop the next directory (the oldest one for bfs_frontier)
+
+        symlink_resolver links{ cur };   // resolves cur's symlinks (see scan_entry.hpp)
+        for (auto const& directory_entry : std::filesystem::directory_iterator{cur})  {
+            // classify_entry() (see scan_entry.hpp) applies the symlink rule and sorts out directories and files
+            switch (classify_entry(directory_entry, links)) {
+                case entry_action::yield:
+                    if (filter.keep_file(directory_entry.path(), depth + 1))
+                        co_yield directory_entry.path(); // return path then resume
+                    break;
+                case entry_action::descend:
+                    if (filter.keep_directory(directory_entry.path(), depth + 1, root_dev))
+                        path_chain.push(directory_entry.path(), depth + 1);
+                    break;
+                case entry_action::skip:
+                    break;
+            }
+        }
+    }
+    co_return; // end of generator
+}
+
+// getdents_bfs_scan() outputs exactly what bfs_scan() does but reads each directory in one go with
+// read_directory_getdents() (see dirent_reader.hpp) and then outputs its files. If reading a directory
+// fails part way, the files read before the error are output and then the error is rethrown (bfs_scan()
+// outputs them as it goes). Frontier is as for bfs_scan()...
+template <scan_frontier_c Frontier = bfs_frontier>
+inline std::generator<std::filesystem::path> getdents_bfs_scan(std::filesystem::path root_path, scan_filter filter = {}, Frontier path_chain = {}) {
+    auto const root_dev = filter.root_device(root_path);
+    path_chain.push(root_path, 0);
+
+    std::vector<std::filesystem::path> files, subdirs;
+    while (!path_chain.empty()) {
+        auto [cur, depth] = path_chain.pop();
+
+        files.clear();
+        subdirs.clear();
+        std::exception_ptr error;   // (can't co_yield in a catch block)
+        try {
+            read_directory(scan_backend::getdents, cur, files, subdirs);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        filter.apply(files, subdirs, depth + 1, root_dev);
+        for (auto const& d : subdirs)
+            path_chain.push(d, depth + 1);
+        for (auto& file : files)
+            co_yield std::move(file);
+        if (error)
+            std::rethrow_exception(error);
+    }
+    co_return;
+}
+
+// arena_bfs_scan() outputs the same paths as bfs_scan() as path_handles into arena (see path_arena.hpp):
+// the queue of directories still to scan holds arena indices (instead of full paths) and keeping every
+// result costs a handle plus the entry's name. A directory that fails part way is handled as in
+// getdents_bfs_scan(). arena must outlive the handles...
+inline std::generator<path_handle> arena_bfs_scan(std::filesystem::path root_path, path_arena& arena, scan_backend backend = scan_backend::iterator, scan_filter filter = {}) {
+    auto const root_dev = filter.root_device(root_path);
+    std::queue<std::pair<path_arena::index_type, std::size_t>> path_chain;
+    path_chain.emplace(arena.add(path_arena::no_parent, root_path.native()), 0);
+
+    std::vector<std::filesystem::path> files, subdirs;
+    while (!path_chain.empty()) {
+        auto const [cur, depth] = path_chain.front();
+        path_chain.pop();
+
+        files.clear();
+        subdirs.clear();
+        std::exception_ptr error;
+        try {
+            read_directory(backend, arena.path(cur), files, subdirs);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        filter.apply(files, subdirs, depth + 1, root_dev);
+        for (auto const& d : subdirs)
+            path_chain.emplace(arena.add(cur, d.filename().native()), depth + 1);
+        for (auto const& file : files)
+            co_yield path_handle{ arena, arena.add(cur, file.filename().native()) };
+        if (error)
+            std::rethrow_exception(error);
+    }
+    co_return;
+}
+
+#endif // include_bfs_scan_hpp_
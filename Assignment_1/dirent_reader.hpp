@@ -0,0 +1,113 @@
+#ifndef include_dirent_reader_hpp_
+#define include_dirent_reader_hpp_
+
+#include <cerrno>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+#include "scan_entry.hpp"
+
+// Which directory reader a scan uses:
+//   iterator  std::filesystem::directory_iterator (portable)
+//   getdents  Linux openat() + getdents64() into a large buffer. Entries are classified from d_type
+//             so the only stat calls are fstatat() for DT_UNKNOWN (some filesystems don't fill d_type).
+//             On other systems this falls back to iterator.
+enum class scan_backend {
+    iterator,
+    getdents
+};
+
+#if defined(__linux__)
+
+// reads the already open directory dir (fd) with getdents64(), see read_directory_getdents()...
+inline void read_directory_fd(unique_fd const& fd, std::filesystem::path const& dir, std::vector<std::filesystem::path>& files, std::vector<std::filesystem::path>& subdirs) {
+    namespace fs = std::filesystem;
+
+    symlink_resolver links{ dir, fd.get() };
+
+    // one buffer per thread, big enough for thousands of entries per system call...
+    constexpr std::size_t buffer_size = 256 * 1024;
+    alignas(dirent64) static thread_local char buffer[buffer_size];
+
+    for (;;) {
+        auto const n = ::syscall(SYS_getdents64, fd.get(), buffer, buffer_size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw fs::filesystem_error("directory iterator cannot advance", dir, std::error_code(errno, std::generic_category()));
+        }
+        if (n == 0)
+            break;
+
+        for (long offset = 0; offset < n; ) {
+            auto const* d = reinterpret_cast<dirent64 const*>(buffer + offset);
+            offset += d->d_reclen;
+
+            std::string_view const name{ d->d_name };
+            if (name == "." || name == "..")
+                continue;
+
+            unsigned char type = d->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                if (::fstatat(fd.get(), d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                    type = IFTODT(st.st_mode);
+            }
+
+            switch (type) {
+                case DT_REG:
+                    files.push_back(dir / name);
+                    break;
+                case DT_DIR:
+                    subdirs.push_back(dir / name);
+                    break;
+                case DT_LNK: {
+                    auto path{ dir / name };
+                    // same as classify_entry(): symlinks that don't resolve are ignored
+                    try {
+                        if (links.is_direct_child(path))
+                            files.push_back(std::move(path));
+                    }
+                    catch (const std::exception& e) {
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+// Same output as read_directory_std(): the same entries in the same (kernel) order, the same symlink rule,
+// and the same filesystem_error messages as directory_iterator.
+inline void read_directory_getdents(std::filesystem::path const& dir, std::vector<std::filesystem::path>& files, std::vector<std::filesystem::path>& subdirs) {
+    unique_fd const fd{ ::openat(AT_FDCWD, dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+    if (fd.get() < 0)
+        throw std::filesystem::filesystem_error("directory iterator cannot open directory", dir, std::error_code(errno, std::generic_category()));
+    read_directory_fd(fd, dir, files, subdirs);
+}
+
+#endif // defined(__linux__)
+
+inline void read_directory(scan_backend backend, std::filesystem::path const& dir, std::vector<std::filesystem::path>& files, std::vector<std::filesystem::path>& subdirs) {
+#if defined(__linux__)
+    if (backend == scan_backend::getdents) {
+        read_directory_getdents(dir, files, subdirs);
+        return;
+    }
+#endif
+    read_directory_std(dir, files, subdirs);
+}
+
+#endif // include_dirent_reader_hpp_
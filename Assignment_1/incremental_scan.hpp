@@ -0,0 +1,286 @@
+#ifndef include_incremental_scan_hpp_
+#define include_incremental_scan_hpp_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <generator>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "dirent_reader.hpp"
+#include "metadata_scan.hpp"
+#include "scan_change.hpp"
+
+// A snapshot of one scanned directory tree so the next scan only has to read the directories that changed.
+// Adding, removing or renaming an entry changes its directory's mtime so a directory whose inode and mtime
+// are the same as in the snapshot still has the same entries and only needs one stat instead of a read.
+struct directory_snapshot {
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint64_t inode = 0;
+    std::int64_t mtime = 0;                                       // file_time_type ticks
+    std::vector<std::string> files;                               // names of the entries bfs_scan() outputs (sorted)
+    std::vector<std::pair<std::string, std::uint32_t>> subdirs;   // name and index (in scan_snapshot::dirs) of each subdirectory (sorted)
+};
+
+struct scan_snapshot {
+    std::int64_t taken = 0;                 // when the scan that made it started (file_time_type ticks)
+    std::vector<directory_snapshot> dirs;   // in BFS order: dirs[0] is the root
+};
+
+// snapshots of every scanned root (i.e., a01's snapshot file) keyed by the root as it was given...
+using scan_snapshots = std::map<std::string, scan_snapshot>;
+
+namespace snapshot_io {
+
+inline constexpr char magic[8] = { 'A', '0', '1', 'S', 'N', 'A', 'P', '1' };
+
+template <typename T>
+void write(std::ostream& os, T v) {
+    os.write(reinterpret_cast<char const*>(&v), sizeof v);
+}
+
+inline void write(std::ostream& os, std::string_view s) {
+    write(os, static_cast<std::uint32_t>(s.size()));
+    os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+template <typename T>
+T read(std::istream& is) {
+    T v{};
+    if (!is.read(reinterpret_cast<char*>(&v), sizeof v))
+        throw std::runtime_error("snapshot file is truncated");
+    return v;
+}
+
+} // namespace snapshot_io
+
+// writes to file.tmp and then renames it over file so an interrupted save leaves the old snapshot...
+inline void save_snapshots(std::filesystem::path const& file, scan_snapshots const& snapshots) {
+    using namespace snapshot_io;
+
+    auto tmp{ file };
+    tmp += ".tmp";
+    {
+        std::ofstream os{ tmp, std::ios::binary | std::ios::trunc };
+        if (!os)
+            throw std::runtime_error("cannot write snapshot file " + tmp.string());
+        os.write(magic, sizeof magic);
+        write(os, static_cast<std::uint64_t>(snapshots.size()));
+        for (auto const& [root, snap] : snapshots) {
+            write(os, std::string_view{ root });
+            write(os, snap.taken);
+            write(os, static_cast<std::uint64_t>(snap.dirs.size()));
+            for (auto const& d : snap.dirs) {
+                write(os, d.inode);
+                write(os, d.mtime);
+                write(os, static_cast<std::uint64_t>(d.files.size()));
+                for (auto const& name : d.files)
+                    write(os, std::string_view{ name });
+                write(os, static_cast<std::uint64_t>(d.subdirs.size()));
+                for (auto const& [name, index] : d.subdirs) {
+                    write(os, std::string_view{ name });
+                    write(os, index);
+                }
+            }
+        }
+        if (!os.flush())
+            throw std::runtime_error("cannot write snapshot file " + tmp.string());
+    }
+    std::filesystem::rename(tmp, file);
+}
+
+// a missing file is an empty set of snapshots (i.e., the first scan)...
+inline scan_snapshots load_snapshots(std::filesystem::path const& file) {
+    using namespace snapshot_io;
+
+    scan_snapshots snapshots;
+    std::ifstream is{ file, std::ios::binary };
+    if (!is)
+        return snapshots;
+
+    char m[sizeof magic];
+    if (!is.read(m, sizeof m) || !std::ranges::equal(m, magic))
+        throw std::runtime_error(file.string() + " is not a snapshot file");
+
+    // every count (and string length) read is checked against what is left of the file before anything
+    // is allocated, each element taking at least min_bytes of it, so a corrupt or truncated file can't
+    // make a huge vector...
+    is.seekg(0, std::ios::end);
+    auto const end = is.tellg();
+    is.seekg(sizeof magic);
+    auto check_count = [&](std::uint64_t n, std::uint64_t min_bytes) {
+        auto const pos = is.tellg();
+        if (pos < 0 || end < pos || n > static_cast<std::uint64_t>(end - pos) / min_bytes)
+            throw std::runtime_error(file.string() + " is corrupt");
+        return static_cast<std::size_t>(n);
+    };
+    auto read_count = [&](std::uint64_t min_bytes) {
+        return check_count(read<std::uint64_t>(is), min_bytes);
+    };
+    auto read_name = [&] {
+        std::string s(check_count(read<std::uint32_t>(is), 1), '\0');
+        if (!is.read(s.data(), static_cast<std::streamsize>(s.size())))
+            throw std::runtime_error("snapshot file is truncated");
+        return s;
+    };
+
+    // (the smallest a directory is: inode, mtime and two counts; a file: its name's length; a
+    // subdirectory: its name's length and index)
+    constexpr std::uint64_t min_dir_bytes = 4 * sizeof(std::uint64_t);
+    constexpr std::uint64_t min_file_bytes = sizeof(std::uint32_t);
+    constexpr std::uint64_t min_subdir_bytes = 2 * sizeof(std::uint32_t);
+
+    for (auto n = read<std::uint64_t>(is); n != 0; --n) {
+        auto root = read_name();
+        scan_snapshot snap;
+        snap.taken = read<std::int64_t>(is);
+        snap.dirs.resize(read_count(min_dir_bytes));
+        for (auto& d : snap.dirs) {
+            d.inode = read<std::uint64_t>(is);
+            d.mtime = read<std::int64_t>(is);
+            d.files.resize(read_count(min_file_bytes));
+            for (auto& name : d.files)
+                name = read_name();
+            d.subdirs.resize(read_count(min_subdir_bytes));
+            for (auto& [name, index] : d.subdirs) {
+                name = read_name();
+                index = read<std::uint32_t>(is);
+                if (index >= snap.dirs.size())
+                    throw std::runtime_error(file.string() + " is corrupt");
+            }
+        }
+        snapshots.emplace(std::move(root), std::move(snap));
+    }
+    return snapshots;
+}
+
+// incremental_bfs_scan() outputs what changed under root_path since old was taken: the paths bfs_scan()
+// would output now but didn't then (added) and the other way around (removed). Without an old snapshot
+// every path is added. A directory is only read if it is new or its inode or mtime changed, otherwise
+// its entries come from old. As it goes it builds next, the snapshot for the next scan (only complete
+// if the generator runs to the end). old and next must outlive the generator.
+//
+// A directory's mtime has a coarse resolution so one that is changed during a scan could keep the mtime
+// that scan saw. To not miss such changes, directories whose mtime isn't a couple of seconds older than
+// the start of the scan that made old are always read (i.e., as git does for its index).
+inline std::generator<scan_change> incremental_bfs_scan(std::filesystem::path root_path, scan_snapshot const* old, scan_snapshot& next) {
+    namespace fs = std::filesystem;
+    using clock = fs::file_time_type::clock;
+
+    next = {};
+    next.taken = clock::now().time_since_epoch().count();
+    auto const racy_margin = std::chrono::duration_cast<fs::file_time_type::duration>(std::chrono::seconds{2}).count();
+
+    // outputs every path old had under (and including) the directory old->dirs[index] at dir as removed...
+    auto removed_subtree = [old](fs::path dir, std::uint32_t index) -> std::generator<scan_change> {
+        std::queue<std::pair<fs::path, std::uint32_t>> q;
+        q.emplace(std::move(dir), index);
+        while (!q.empty()) {
+            auto [d, i] = std::move(q.front());
+            q.pop();
+            for (auto const& name : old->dirs[i].files) {
+                scan_change change{ change_kind::removed, d / name };
+                co_yield std::move(change);
+            }
+            for (auto const& [name, child] : old->dirs[i].subdirs)
+                q.emplace(d / name, child);
+        }
+    };
+
+    // (directory, its index in old or none); its index in next is its position in this queue...
+    std::queue<std::pair<fs::path, std::uint32_t>> path_chain;
+    path_chain.emplace(std::move(root_path), old && !old->dirs.empty() ? 0 : directory_snapshot::none);
+    next.dirs.emplace_back();
+
+    std::vector<fs::path> files, subdirs;
+    std::vector<std::string> names;
+    for (std::size_t cur_index = 0; !path_chain.empty(); ++cur_index) {
+        auto [cur, old_index] = std::move(path_chain.front());
+        path_chain.pop();
+
+        auto const meta = stat_file(cur);
+        if (meta.error)
+            throw fs::filesystem_error("directory iterator cannot open directory", cur, meta.error);
+
+        directory_snapshot const* before = old_index != directory_snapshot::none ? &old->dirs[old_index] : nullptr;
+        directory_snapshot now;
+        now.inode = meta.inode;
+        now.mtime = meta.mtime.time_since_epoch().count();
+
+        if (before && before->inode == now.inode && before->mtime == now.mtime && now.mtime < old->taken - racy_margin) {
+            // unchanged: same entries, but its subdirectories still have to be checked...
+            now.files = before->files;
+            for (auto const& [name, child] : before->subdirs) {
+                now.subdirs.emplace_back(name, static_cast<std::uint32_t>(next.dirs.size()));
+                next.dirs.emplace_back();
+                path_chain.emplace(cur / name, child);
+            }
+        }
+        else {
+            files.clear();
+            subdirs.clear();
+            read_directory(scan_backend::getdents, cur, files, subdirs);
+
+            for (auto const& f : files)
+                now.files.push_back(f.filename().string());
+            std::ranges::sort(now.files);
+
+            names.clear();
+            for (auto const& d : subdirs)
+                names.push_back(d.filename().string());
+            std::ranges::sort(names);
+
+            // compare the sorted entries with before's...
+            static std::vector<std::string> const no_names;
+            auto const& old_files = before ? before->files : no_names;
+            std::vector<std::string> changed;
+            std::ranges::set_difference(old_files, now.files, std::back_inserter(changed));
+            for (auto const& name : changed) {
+                scan_change change{ change_kind::removed, cur / name };
+                co_yield std::move(change);
+            }
+            changed.clear();
+            std::ranges::set_difference(now.files, old_files, std::back_inserter(changed));
+            for (auto const& name : changed) {
+                scan_change change{ change_kind::added, cur / name };
+                co_yield std::move(change);
+            }
+
+            // subdirectories: new ones are scanned from scratch, removed ones take everything under them...
+            std::size_t o = 0;
+            auto const old_subdir_count = before ? before->subdirs.size() : 0;
+            for (auto const& name : names) {
+                for (; o < old_subdir_count && before->subdirs[o].first < name; ++o)
+                    for (auto&& change : removed_subtree(cur / before->subdirs[o].first, before->subdirs[o].second))
+                        co_yield std::move(change);
+                std::uint32_t child = directory_snapshot::none;
+                if (o < old_subdir_count && before->subdirs[o].first == name)
+                    child = before->subdirs[o++].second;
+                now.subdirs.emplace_back(name, static_cast<std::uint32_t>(next.dirs.size()));
+                next.dirs.emplace_back();
+                path_chain.emplace(cur / name, child);
+            }
+            for (; o < old_subdir_count; ++o)
+                for (auto&& change : removed_subtree(cur / before->subdirs[o].first, before->subdirs[o].second))
+                    co_yield std::move(change);
+        }
+
+        next.dirs[cur_index] = std::move(now);
+    }
+    co_return;
+}
+
+#endif // include_incremental_scan_hpp_
@@ -0,0 +1,174 @@
+#ifndef include_io_uring_queue_hpp_
+#define include_io_uring_queue_hpp_
+
+// io_uring is Linux only (5.6 or later for openat and statx requests). HAVE_IO_URING_QUEUE is defined
+// when io_uring_queue is available...
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING_QUEUE 1
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// io_uring_queue is just enough of io_uring (without liburing) to keep many system calls in flight
+// from one thread: requests are written into the shared submission ring, one io_uring_enter() call
+// submits them all and their results are read from the shared completion ring.
+class io_uring_queue {
+    int fd_ = -1;
+    unsigned entries_ = 0;
+
+    void* sq_ring_ = MAP_FAILED;
+    std::size_t sq_ring_size_ = 0;
+    void* cq_ring_ = MAP_FAILED;
+    std::size_t cq_ring_size_ = 0;
+    void* sqes_ = MAP_FAILED;
+    std::size_t sqes_size_ = 0;
+
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    unsigned sq_local_tail_ = 0;   // entries up to here are filled in
+    unsigned to_submit_ = 0;       // filled in but not yet submitted
+
+    void release() noexcept {
+        if (sqes_ != MAP_FAILED)
+            ::munmap(sqes_, sqes_size_);
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+            ::munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_ != MAP_FAILED)
+            ::munmap(sq_ring_, sq_ring_size_);
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    [[noreturn]] void fail(char const* what) {
+        std::error_code const ec(errno, std::system_category());
+        release();
+        throw std::system_error(ec, what);
+    }
+
+    template <typename T>
+    static T* at(void* ring, std::uint32_t offset) noexcept {
+        return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+    }
+
+public:
+    // throws std::system_error if io_uring can't be used (e.g., too old a kernel or it is disabled)...
+    explicit io_uring_queue(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof p);
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0)
+            fail("io_uring_setup");
+        entries_ = p.sq_entries;
+
+        sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool const single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap)
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED)
+            fail("mmap");
+        cq_ring_ = single_mmap ? sq_ring_ : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED)
+            fail("mmap");
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED)
+            fail("mmap");
+
+        sq_tail_ = at<unsigned>(sq_ring_, p.sq_off.tail);
+        sq_mask_ = at<unsigned>(sq_ring_, p.sq_off.ring_mask);
+        sq_array_ = at<unsigned>(sq_ring_, p.sq_off.array);
+        cq_head_ = at<unsigned>(cq_ring_, p.cq_off.head);
+        cq_tail_ = at<unsigned>(cq_ring_, p.cq_off.tail);
+        cq_mask_ = at<unsigned>(cq_ring_, p.cq_off.ring_mask);
+        cqes_ = at<io_uring_cqe>(cq_ring_, p.cq_off.cqes);
+        sq_local_tail_ = *sq_tail_;
+    }
+
+    io_uring_queue(io_uring_queue const&) = delete;
+    io_uring_queue& operator=(io_uring_queue const&) = delete;
+
+    ~io_uring_queue() { release(); }
+
+    // the most requests that can be in flight at once...
+    unsigned capacity() const noexcept { return entries_; }
+
+    // the next (zeroed) submission entry to fill in: at most capacity() may be in flight...
+    io_uring_sqe& next_sqe() noexcept {
+        unsigned const index = sq_local_tail_++ & *sq_mask_;
+        sq_array_[index] = index;
+        auto* const sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+        std::memset(sqe, 0, sizeof *sqe);
+        ++to_submit_;
+        return *sqe;
+    }
+
+    // submits the entries from next_sqe() and waits until at least wait_nr requests have completed...
+    void submit_and_wait(unsigned wait_nr) {
+        std::atomic_ref<unsigned>{ *sq_tail_ }.store(sq_local_tail_, std::memory_order_release);
+        for (;;) {
+            auto const r = ::syscall(__NR_io_uring_enter, fd_, to_submit_, wait_nr, wait_nr != 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (r >= 0) {
+                to_submit_ -= static_cast<unsigned>(r);
+                if (to_submit_ == 0 || wait_nr != 0)
+                    return;
+            }
+            else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                throw std::system_error(errno, std::system_category(), "io_uring_enter");
+        }
+    }
+
+    // calls f(user_data, res) for each completed request (res is a system call result or -errno) and
+    // returns how many there were...
+    template <typename F>
+    unsigned drain(F f) {
+        unsigned head = *cq_head_;
+        unsigned const tail = std::atomic_ref<unsigned>{ *cq_tail_ }.load(std::memory_order_acquire);
+        unsigned n = 0;
+        for (; head != tail; ++head, ++n) {
+            auto const& cqe = cqes_[head & *cq_mask_];
+            f(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>{ *cq_head_ }.store(head, std::memory_order_release);
+        return n;
+    }
+
+    // runs n requests keeping up to capacity() in flight: prepare(sqe, i) fills in request i and
+    // complete(i, res) is given its result. Neither may throw since requests in flight refer to the
+    // caller's buffers...
+    template <typename Prepare, typename Complete>
+    void run(std::size_t n, Prepare prepare, Complete complete) {
+        std::size_t next = 0, in_flight = 0;
+        while (next < n || in_flight != 0) {
+            for (; next < n && in_flight < entries_; ++next, ++in_flight) {
+                auto& sqe = next_sqe();
+                prepare(sqe, next);
+                sqe.user_data = next;
+            }
+            submit_and_wait(1);
+            in_flight -= drain([&](std::uint64_t i, int res) { complete(static_cast<std::size_t>(i), res); });
+        }
+    }
+};
+
+#endif // defined(__linux__) && __has_include(<linux/io_uring.h>)
+
+#endif // include_io_uring_queue_hpp_
@@ -0,0 +1,369 @@
+#ifndef include_metadata_scan_hpp_
+#define include_metadata_scan_hpp_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <generator>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include "dirent_reader.hpp"
+#include "io_uring_queue.hpp"
+#include "scan_filter.hpp"
+
+// What a metadata scan reports for each path (the path's target for symlinks, like std::filesystem::status())...
+struct file_metadata {
+    std::uintmax_t size = 0;
+    std::filesystem::file_time_type mtime{};
+    std::filesystem::file_type type = std::filesystem::file_type::none;
+    std::filesystem::perms permissions = std::filesystem::perms::unknown;
+    std::uintmax_t inode = 0;
+    std::error_code error;   // set if the path couldn't be stat'ed (then the rest is unset)
+};
+
+struct scan_record {
+    std::filesystem::path path;
+    file_metadata metadata;
+};
+
+struct metadata_scan_options {
+    unsigned queue_depth = 256;   // io_uring requests kept in flight (also the directories read per batch)
+    unsigned threads = 0;         // thread pool fallback size, 0 means std::thread::hardware_concurrency()
+    bool use_io_uring = true;     // false always uses the thread pool
+    scan_filter filter;           // see scan_filter.hpp (size and time filters use the scan's own metadata)
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+
+inline std::filesystem::file_type file_type_of_mode(unsigned mode) noexcept {
+    using std::filesystem::file_type;
+    switch (mode & S_IFMT) {
+        case S_IFREG:  return file_type::regular;
+        case S_IFDIR:  return file_type::directory;
+        case S_IFLNK:  return file_type::symlink;
+        case S_IFBLK:  return file_type::block;
+        case S_IFCHR:  return file_type::character;
+        case S_IFIFO:  return file_type::fifo;
+        case S_IFSOCK: return file_type::socket;
+        default:       return file_type::unknown;
+    }
+}
+
+inline std::filesystem::file_time_type file_time_of(std::int64_t sec, std::int64_t nsec) {
+    using namespace std::chrono;
+    return file_clock::from_sys(sys_time<nanoseconds>{ seconds{sec} + nanoseconds{nsec} });
+}
+
+#endif
+
+// stat_file() is one synchronous stat (used by the thread pool fallback)...
+inline file_metadata stat_file(std::filesystem::path const& p) {
+    file_metadata m;
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat st;
+    if (::stat(p.c_str(), &st) != 0) {
+        m.error = std::error_code(errno, std::generic_category());
+        return m;
+    }
+    m.size = static_cast<std::uintmax_t>(st.st_size);
+#if defined(__APPLE__)
+    m.mtime = file_time_of(st.st_mtimespec.tv_sec, st.st_mtimespec.tv_nsec);
+#else
+    m.mtime = file_time_of(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+#endif
+    m.type = file_type_of_mode(st.st_mode);
+    m.permissions = static_cast<std::filesystem::perms>(st.st_mode & 07777);
+    m.inode = static_cast<std::uintmax_t>(st.st_ino);
+#else
+    namespace fs = std::filesystem;
+    auto const s = fs::status(p, m.error);
+    if (m.error)
+        return m;
+    m.type = s.type();
+    m.permissions = s.permissions();
+    if (m.type == fs::file_type::regular)
+        m.size = fs::file_size(p, m.error);
+    if (!m.error)
+        m.mtime = fs::last_write_time(p, m.error);
+#endif
+    return m;
+}
+
+// parallel_for_pool runs f(0), ..., f(n-1) on its threads and the calling thread and returns when they
+// are all done. The threads are started once and wait between calls...
+class parallel_for_pool {
+    std::mutex m_;
+    std::condition_variable_any work_ready_;
+    std::condition_variable work_done_;
+    std::function<void(std::size_t)> const* job_ = nullptr;
+    std::size_t n_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t generation_ = 0;
+    unsigned busy_ = 0;
+    std::vector<std::jthread> threads_;   // last so they are stopped and joined first
+
+    void take_indices(std::function<void(std::size_t)> const& f, std::size_t n) {
+        for (std::size_t i; (i = next_.fetch_add(1, std::memory_order_relaxed)) < n; )
+            f(i);
+    }
+
+    void work(std::stop_token stoken) {
+        std::size_t seen = 0;
+        for (;;) {
+            std::function<void(std::size_t)> const* job;
+            std::size_t n;
+            {
+                std::unique_lock lk{m_};
+                if (!work_ready_.wait(lk, stoken, [&] { return generation_ != seen; }))
+                    return;
+                seen = generation_;
+                if (job_ == nullptr)   // woke up after that run() was already done
+                    continue;
+                // run() waits for busy_ to drop to 0 so job stays valid until then...
+                job = job_;
+                n = n_;
+                ++busy_;
+            }
+            take_indices(*job, n);
+            {
+                std::lock_guard lk{m_};
+                --busy_;
+            }
+            work_done_.notify_one();
+        }
+    }
+
+public:
+    explicit parallel_for_pool(unsigned threads = 0) {
+        unsigned const n = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        threads_.reserve(n - 1);
+        for (unsigned i = 1; i < n; ++i)
+            threads_.emplace_back([this](std::stop_token stoken) { work(stoken); });
+    }
+
+    // f must not throw...
+    void run(std::size_t n, std::function<void(std::size_t)> const& f) {
+        {
+            std::lock_guard lk{m_};
+            job_ = &f;
+            n_ = n;
+            next_.store(0, std::memory_order_relaxed);
+            ++generation_;
+        }
+        work_ready_.notify_all();
+        take_indices(f, n);
+
+        std::unique_lock lk{m_};
+        work_done_.wait(lk, [&] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+};
+
+#if defined(HAVE_IO_URING_QUEUE)
+
+inline file_metadata metadata_of_statx(struct statx const& stx) {
+    file_metadata m;
+    m.size = stx.stx_size;
+    m.mtime = file_time_of(stx.stx_mtime.tv_sec, stx.stx_mtime.tv_nsec);
+    m.type = file_type_of_mode(stx.stx_mode);
+    m.permissions = static_cast<std::filesystem::perms>(stx.stx_mode & 07777);
+    m.inode = stx.stx_ino;
+    return m;
+}
+
+// statx() for every path through ring...
+inline void stat_files_uring(io_uring_queue& ring, std::vector<std::filesystem::path> const& paths, std::vector<file_metadata>& meta) {
+    std::vector<struct statx> buffers(paths.size());
+    ring.run(paths.size(),
+        [&](io_uring_sqe& sqe, std::size_t i) {
+            sqe.opcode = IORING_OP_STATX;
+            sqe.fd = AT_FDCWD;
+            sqe.addr = reinterpret_cast<std::uintptr_t>(paths[i].c_str());
+            sqe.len = STATX_BASIC_STATS;
+            sqe.off = reinterpret_cast<std::uintptr_t>(&buffers[i]);
+        },
+        [&](std::size_t i, int res) {
+            if (res < 0)
+                meta[i].error = std::error_code(-res, std::generic_category());
+            else
+                meta[i] = metadata_of_statx(buffers[i]);
+        });
+}
+
+// opens every directory through ring and then reads each one (getdents64() has no io_uring request)...
+inline void open_directories_uring(io_uring_queue& ring, std::vector<std::filesystem::path> const& dirs, std::vector<int>& fds) {
+    fds.assign(dirs.size(), -1);
+    ring.run(dirs.size(),
+        [&](io_uring_sqe& sqe, std::size_t i) {
+            sqe.opcode = IORING_OP_OPENAT;
+            sqe.fd = AT_FDCWD;
+            sqe.addr = reinterpret_cast<std::uintptr_t>(dirs[i].c_str());
+            sqe.open_flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+        },
+        [&](std::size_t i, int res) { fds[i] = res; });
+}
+
+// makes ring one that can do openat and statx requests (they need Linux 5.6 or later) or leaves it empty...
+inline void open_metadata_ring(std::optional<io_uring_queue>& ring, unsigned queue_depth) {
+    try {
+        ring.emplace(queue_depth);
+    }
+    catch (std::system_error const&) {
+        return;
+    }
+    std::vector<std::filesystem::path> const probe{ "/" };
+    std::vector<file_metadata> meta(1);
+    stat_files_uring(*ring, probe, meta);
+    if (meta[0].error == std::errc::invalid_argument || meta[0].error == std::errc::operation_not_supported)
+        ring.reset();
+}
+
+#endif // defined(HAVE_IO_URING_QUEUE)
+
+// does metadata_bfs_scan() get to use io_uring (i.e., would its ring open) or does it fall back to the
+// thread pool?
+inline bool metadata_io_uring_available(unsigned queue_depth = metadata_scan_options{}.queue_depth) {
+#if defined(HAVE_IO_URING_QUEUE)
+    std::optional<io_uring_queue> ring;
+    open_metadata_ring(ring, queue_depth);
+    return ring.has_value();
+#else
+    (void)queue_depth;
+    return false;
+#endif
+}
+
+// metadata_bfs_scan() outputs the same paths in the same order as bfs_scan(), each with its metadata.
+// Instead of one blocking stat per file it works a batch of directories at a time:
+//   * io_uring (Linux): the batch's directories are opened with up to queue_depth opens in flight,
+//     read with getdents64() and then all of their files are stat'ed with up to queue_depth statx
+//     requests in flight, so cold-cache scans are limited by the device queue depth, not by seeks.
+//   * otherwise (or if io_uring isn't available) a thread pool reads the batch's directories and
+//     stats their files in parallel.
+inline std::generator<scan_record> metadata_bfs_scan(std::filesystem::path root_path, metadata_scan_options opts = {}) {
+    namespace fs = std::filesystem;
+
+    struct dir_read {
+        std::vector<fs::path> files;
+        std::vector<fs::path> subdirs;
+        std::exception_ptr error;
+    };
+
+    auto const& filter = opts.filter;
+    auto const root_dev = filter.root_device(root_path);
+    std::deque<std::pair<fs::path, std::size_t>> path_chain;   // (directory, its depth) with root at depth 0
+    path_chain.emplace_back(std::move(root_path), 0);
+
+#if defined(HAVE_IO_URING_QUEUE)
+    std::optional<io_uring_queue> ring;
+    if (opts.use_io_uring)
+        open_metadata_ring(ring, opts.queue_depth);
+    bool const use_ring = ring.has_value();
+#else
+    bool const use_ring = false;
+#endif
+    std::optional<parallel_for_pool> pool;
+    if (!use_ring)
+        pool.emplace(opts.threads);
+
+    std::size_t const batch_size = std::max(1u, opts.queue_depth);
+    std::vector<fs::path> dirs;
+    std::vector<std::size_t> depths;
+    std::vector<dir_read> reads;
+    std::vector<fs::path> files;
+    std::vector<file_metadata> meta;
+
+    while (!path_chain.empty()) {
+        dirs.clear();
+        depths.clear();
+        for (; !path_chain.empty() && dirs.size() < batch_size; path_chain.pop_front()) {
+            dirs.push_back(std::move(path_chain.front().first));
+            depths.push_back(path_chain.front().second);
+        }
+
+        reads.clear();
+        reads.resize(dirs.size());
+        if (use_ring) {
+#if defined(HAVE_IO_URING_QUEUE)
+            std::vector<int> fds;
+            open_directories_uring(*ring, dirs, fds);
+            for (std::size_t i = 0; i < dirs.size(); ++i) {
+                unique_fd const fd{ fds[i] };
+                try {
+                    if (fds[i] < 0)
+                        throw fs::filesystem_error("directory iterator cannot open directory", dirs[i], std::error_code(-fds[i], std::generic_category()));
+                    read_directory_fd(fd, dirs[i], reads[i].files, reads[i].subdirs);
+                }
+                catch (...) {
+                    reads[i].error = std::current_exception();
+                }
+            }
+#endif
+        }
+        else {
+            pool->run(dirs.size(), [&](std::size_t i) {
+                try {
+                    read_directory(scan_backend::getdents, dirs[i], reads[i].files, reads[i].subdirs);
+                }
+                catch (...) {
+                    reads[i].error = std::current_exception();
+                }
+            });
+        }
+
+        // in BFS order queue the subdirectories and gather the files, up to the first directory that failed...
+        std::exception_ptr error;
+        files.clear();
+        for (std::size_t i = 0; i < dirs.size(); ++i) {
+            if (reads[i].error) {
+                error = reads[i].error;
+                break;
+            }
+            filter.apply(reads[i].files, reads[i].subdirs, depths[i] + 1, root_dev, false);
+            for (auto& d : reads[i].subdirs)
+                path_chain.emplace_back(std::move(d), depths[i] + 1);
+            for (auto& f : reads[i].files)
+                files.push_back(std::move(f));
+        }
+
+        meta.clear();
+        meta.resize(files.size());
+        if (use_ring) {
+#if defined(HAVE_IO_URING_QUEUE)
+            stat_files_uring(*ring, files, meta);
+#endif
+        }
+        else
+            pool->run(files.size(), [&](std::size_t i) { meta[i] = stat_file(files[i]); });
+
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            if (filter.has_attribute_filters() && (meta[i].error || !filter.keep_attributes(meta[i].size, meta[i].mtime)))
+                continue;
+            scan_record record{ std::move(files[i]), meta[i] };
+            co_yield std::move(record);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+    co_return;
+}
+
+#endif // include_metadata_scan_hpp_
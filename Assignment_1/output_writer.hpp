@@ -0,0 +1,135 @@
+#ifndef include_output_writer_hpp_
+#define include_output_writer_hpp_
+
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+// How output_writer writes a path:
+//   quoted  exactly as std::cout << path does (in double quotes with " and \ escaped by a backslash)
+//   raw     the path's bytes as they are (e.g., for xargs -0)
+enum class path_format {
+    quoted,
+    raw
+};
+
+// output_writer collects the output in a large buffer and writes it with write(2) when the buffer is full
+// (or on flush()), i.e., one system call per megabyte instead of going through iostreams per path.
+// Call flush() before writing to std::cerr so output to the same terminal or file stays in order.
+class output_writer {
+    int fd_;
+    path_format format_;
+    char terminator_;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+
+    void write_out(char const* p, std::size_t n) {
+#if defined(__unix__) || defined(__APPLE__)
+        while (n != 0) {
+            auto const r = ::write(fd_, p, n);
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "write");
+            }
+            p += r;
+            n -= static_cast<std::size_t>(r);
+        }
+#else
+        if (std::fwrite(p, 1, n, fd_ == 2 ? stderr : stdout) != n)
+            throw std::system_error(errno, std::generic_category(), "fwrite");
+#endif
+    }
+
+public:
+    explicit output_writer(int fd = 1, path_format format = path_format::quoted, char terminator = '\n', std::size_t buffer_size = 1 << 20)
+        : fd_{fd}, format_{format}, terminator_{terminator}, buffer_(buffer_size) {}
+
+    output_writer(output_writer const&) = delete;
+    output_writer& operator=(output_writer const&) = delete;
+
+    ~output_writer() {
+        try {
+            flush();
+        }
+        catch (...) {
+        }
+    }
+
+    void flush() {
+        auto const n = used_;
+        used_ = 0;   // (so a failed write isn't written again by the destructor)
+        write_out(buffer_.data(), n);
+    }
+
+    void put(char c) {
+        if (used_ == buffer_.size())
+            flush();
+        buffer_[used_++] = c;
+    }
+
+    void write(std::string_view s) {
+        if (s.size() > buffer_.size() - used_) {
+            flush();
+            if (s.size() >= buffer_.size()) {
+                write_out(s.data(), s.size());
+                return;
+            }
+        }
+        s.copy(buffer_.data() + used_, s.size());
+        used_ += s.size();
+    }
+
+    template <std::integral T>
+    void write(T v) {
+        char digits[24];
+        auto const [end, ec] = std::to_chars(digits, digits + sizeof digits, v);
+        write(std::string_view{ digits, static_cast<std::size_t>(end - digits) });
+    }
+
+    // writes a path already in bytes (see write_path())...
+    void write_path_bytes(std::string_view s) {
+        if (format_ == path_format::raw) {
+            write(s);
+            return;
+        }
+        put('"');
+        for (std::size_t i = 0; i < s.size(); ) {
+            auto const special = s.find_first_of("\"\\", i);
+            write(s.substr(i, special - i));
+            if (special == std::string_view::npos)
+                break;
+            put('\\');
+            put(s[special]);
+            i = special + 1;
+        }
+        put('"');
+    }
+
+    // native() is only a char string on POSIX systems (e.g., on Windows it is a wstring which string()
+    // converts)...
+    void write_path(std::filesystem::path const& p) {
+#if defined(__unix__) || defined(__APPLE__)
+        write_path_bytes(p.native());
+#else
+        write_path_bytes(p.string());
+#endif
+    }
+
+    // ends a record (one line or, with -0, one NUL terminated entry)...
+    void end_record() {
+        put(terminator_);
+    }
+};
+
+#endif // include_output_writer_hpp_
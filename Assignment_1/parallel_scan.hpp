@@ -0,0 +1,177 @@
+#ifndef include_parallel_scan_hpp_
+#define include_parallel_scan_hpp_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <generator>
+#include <map>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dirent_reader.hpp"
+#include "scan_entry.hpp"
+#include "scan_filter.hpp"
+
+struct parallel_scan_options {
+    unsigned threads = 0;  // 0 means std::thread::hardware_concurrency()
+    bool ordered = true;   // false: output as soon as a directory is read (same set, any order)
+    scan_backend backend = scan_backend::iterator;  // how the workers read a directory
+    scan_filter filter;    // applied by the workers as they read each directory (see scan_filter.hpp)
+};
+
+// parallel_bfs_scan() outputs the same paths as bfs_scan() but N worker threads read the directories
+// (directory_iterator is latency bound, so many reads in flight hide the latency).
+//
+// The workers pull directories from a shared work queue and hand back one result per directory
+// (its files and its subdirectories). The generator (i.e., the consuming thread) is the coordinator:
+//
+//   * ordered: directories are numbered in BFS order. The coordinator outputs results in that order
+//     and only then numbers and queues their subdirectories, so the output is exactly bfs_scan()'s
+//     order while the whole BFS frontier is being read in parallel.
+//   * unordered: workers queue subdirectories themselves and results are output as they arrive.
+//
+// An exception reading a directory (e.g., permission denied) is rethrown by the generator when that
+// directory's result is reached, as bfs_scan() would. Destroying the generator stops the workers.
+inline std::generator<std::filesystem::path> parallel_bfs_scan(std::filesystem::path root_path, parallel_scan_options opts = {}) {
+    namespace fs = std::filesystem;
+
+    struct dir_job {
+        std::size_t seq;
+        std::size_t depth;   // the root is at depth 0
+        fs::path dir;
+    };
+
+    struct dir_result {
+        std::size_t seq;
+        std::size_t depth;
+        std::vector<fs::path> files;
+        std::vector<fs::path> subdirs;
+        std::exception_ptr error;
+    };
+
+    struct shared_state {
+        std::mutex m;
+        std::condition_variable_any work_ready;   // workers wait here for directories
+        std::condition_variable results_ready;    // the generator waits here for results
+        std::deque<dir_job> work;
+        std::deque<dir_result> results;
+        std::size_t in_flight = 0;                // directories queued or being read (result not yet taken)
+    } state;
+
+    bool const ordered = opts.ordered;
+    scan_backend const backend = opts.backend;
+    scan_filter const& filter = opts.filter;
+    auto const root_dev = filter.root_device(root_path);
+
+    auto worker = [&state, ordered, backend, &filter, root_dev](std::stop_token stoken) {
+        for (;;) {
+            dir_job job;
+            {
+                std::unique_lock lk{state.m};
+                if (!state.work_ready.wait(lk, stoken, [&] { return !state.work.empty(); }))
+                    return;
+                job = std::move(state.work.front());
+                state.work.pop_front();
+            }
+
+            dir_result r{job.seq, job.depth, {}, {}, {}};
+            try {
+                read_directory(backend, job.dir, r.files, r.subdirs);
+                filter.apply(r.files, r.subdirs, job.depth + 1, root_dev);
+            }
+            catch (...) {
+                r.error = std::current_exception();
+            }
+
+            {
+                std::lock_guard lk{state.m};
+                if (!ordered && !r.error) {
+                    // queue the subdirectories before the result is counted done so in_flight never drops to 0 early
+                    for (auto& d : r.subdirs)
+                        state.work.push_back({0, job.depth + 1, std::move(d)});
+                    state.in_flight += r.subdirs.size();
+                    if (r.subdirs.size() == 1)
+                        state.work_ready.notify_one();
+                    else if (!r.subdirs.empty())
+                        state.work_ready.notify_all();
+                    r.subdirs.clear();
+                }
+                state.results.push_back(std::move(r));
+            }
+            state.results_ready.notify_one();
+        }
+    };
+
+    // queues directories (numbered in BFS order) for the workers...
+    std::size_t next_seq = 0;
+    auto queue_dirs = [&](std::vector<fs::path>& dirs, std::size_t depth) {
+        if (dirs.empty())
+            return;
+        {
+            std::lock_guard lk{state.m};
+            for (auto& d : dirs)
+                state.work.push_back({next_seq++, depth, std::move(d)});
+            state.in_flight += dirs.size();
+        }
+        state.work_ready.notify_all();
+    };
+
+    std::vector<fs::path> root{ std::move(root_path) };
+    queue_dirs(root, 0);
+
+    // declared after state so they are stopped and joined before it goes away...
+    unsigned const n = opts.threads != 0 ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::jthread> workers;
+    workers.reserve(n);
+    for (unsigned i = 0; i < n; ++i)
+        workers.emplace_back(worker);
+
+    std::map<std::size_t, dir_result> pending; // (ordered) results that arrived ahead of their turn
+    std::size_t next_to_output = 0;
+
+    for (;;) {
+        std::deque<dir_result> batch;
+        {
+            std::unique_lock lk{state.m};
+            state.results_ready.wait(lk, [&] { return !state.results.empty() || state.in_flight == 0; });
+            if (state.results.empty())
+                break;
+            batch.swap(state.results);
+            state.in_flight -= batch.size();
+        }
+
+        for (auto& r : batch) {
+            if (!ordered) {
+                if (r.error)
+                    std::rethrow_exception(r.error);
+                for (auto& file : r.files)
+                    co_yield std::move(file);
+                continue;
+            }
+
+            pending.emplace(r.seq, std::move(r));
+            for (auto it = pending.find(next_to_output); it != pending.end(); it = pending.find(next_to_output)) {
+                auto cur{ std::move(it->second) };
+                pending.erase(it);
+                ++next_to_output;
+
+                if (cur.error)
+                    std::rethrow_exception(cur.error);
+                // queue the subdirectories first so the workers keep busy while the consumer runs...
+                queue_dirs(cur.subdirs, cur.depth + 1);
+                for (auto& file : cur.files)
+                    co_yield std::move(file);
+            }
+        }
+    }
+    co_return;
+}
+
+#endif // include_parallel_scan_hpp_
@@ -0,0 +1,108 @@
+#ifndef include_path_arena_hpp_
+#define include_path_arena_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// path_arena stores a whole scan's paths compactly: one node per path holding the index of its parent's
+// node and where its name is in one big string of all the names. So a path costs 16 bytes plus its
+// own name (instead of a heap allocated copy of the full path) and directory prefixes are stored once.
+// Nodes are only ever added so an index stays valid until clear().
+class path_arena {
+public:
+    using index_type = std::uint32_t;
+    using string_type = std::filesystem::path::string_type;
+    using string_view_type = std::basic_string_view<std::filesystem::path::value_type>;
+
+    static constexpr index_type no_parent = std::numeric_limits<index_type>::max();
+
+private:
+    struct node {
+        index_type parent;
+        std::uint32_t name_size;
+        std::uint64_t name_offset;
+    };
+
+    std::vector<node> nodes_;
+    string_type names_;
+
+public:
+    // adds a path (parent == no_parent means name is a whole root path, e.g., as passed on the command line)...
+    index_type add(index_type parent, string_view_type name) {
+        if (nodes_.size() >= no_parent)
+            throw std::length_error("path_arena is full");
+        nodes_.push_back({ parent, static_cast<std::uint32_t>(name.size()), names_.size() });
+        names_.append(name);
+        return static_cast<index_type>(nodes_.size() - 1);
+    }
+
+    index_type parent(index_type i) const { return nodes_[i].parent; }
+
+    string_view_type name(index_type i) const {
+        auto const& n = nodes_[i];
+        return string_view_type{ names_ }.substr(n.name_offset, n.name_size);
+    }
+
+    // builds the full path exactly as root / name / ... / name (i.e., as directory_iterator would have)...
+    std::filesystem::path path(index_type i) const {
+        index_type chain[256];   // deeper paths are built without it (below)
+        std::size_t depth = 0;
+        for (index_type k = i; k != no_parent; k = nodes_[k].parent) {
+            if (depth == std::size(chain)) {
+                std::filesystem::path p{ path(k) };
+                while (depth != 0)
+                    p /= name(chain[--depth]);
+                return p;
+            }
+            chain[depth++] = k;
+        }
+
+        std::filesystem::path p{ name(chain[--depth]) };
+        while (depth != 0)
+            p /= name(chain[--depth]);
+        return p;
+    }
+
+    std::size_t size() const noexcept { return nodes_.size(); }
+
+    // bytes held by the arena (capacity, not size, since that is what is actually allocated)...
+    std::size_t memory_bytes() const noexcept {
+        return nodes_.capacity() * sizeof(node) + names_.capacity() * sizeof(std::filesystem::path::value_type);
+    }
+
+    void clear() noexcept {
+        nodes_.clear();
+        names_.clear();
+    }
+};
+
+// path_handle refers to one path in a path_arena: it is small and cheap to copy and the full path is
+// only made (with path()) when it is needed. The arena must outlive the handle.
+class path_handle {
+    path_arena const* arena_ = nullptr;
+    path_arena::index_type index_ = 0;
+
+public:
+    path_handle() = default;
+    path_handle(path_arena const& arena, path_arena::index_type index) noexcept : arena_{&arena}, index_{index} {}
+
+    path_arena::index_type index() const noexcept { return index_; }
+    path_arena::string_view_type filename() const { return arena_->name(index_); }
+    std::filesystem::path path() const { return arena_->path(index_); }
+
+    friend bool operator==(path_handle const&, path_handle const&) = default;
+};
+
+// outputs the path the same way (i.e., quoted) as std::filesystem::path...
+inline std::ostream& operator<<(std::ostream& os, path_handle const& h) {
+    return os << h.path();
+}
+
+#endif // include_path_arena_hpp_
@@ -0,0 +1,148 @@
+// scan_bench: compares the directory readers (see dirent_reader.hpp) on a large generated tree.
+//
+// Usage: scan_bench.exe [DIR [FILES]]
+//
+// If DIR (default scan_bench_tree) does not exist a tree with FILES (default 1,000,000) files is made
+// in it: 1000 files per leaf directory, 10 leaves per middle directory, plus a few symlinks.
+// Each scanner is run twice (the first run warms the dentry/inode caches) and the second run is timed.
+// (For the metadata scanners' cold-cache behaviour run as root with a single scanner between
+// `echo 3 > /proc/sys/vm/drop_caches` calls instead.)
+// Every scanner must output the same number of paths as bfs_scan() otherwise the run is an error.
+// result_bytes is the memory needed to keep every output path: a std::filesystem::path and its string
+// per path (a lower bound: a path may also allocate a list of its components), or for arena_bfs_scan()
+// a path_handle per path plus the path_arena.
+//
+// Outputs CSV (to std::cout) with the columns:
+//   scanner,threads,paths,seconds,paths_per_sec,result_bytes
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <generator>
+#include <iostream>
+#include <print>
+#include <string>
+#include <thread>
+
+#include "bfs_scan.hpp"
+#include "metadata_scan.hpp"
+#include "parallel_scan.hpp"
+
+namespace fs = std::filesystem;
+
+void make_tree(fs::path const& root, std::size_t files) {
+    constexpr std::size_t files_per_leaf = 1000;
+    constexpr std::size_t leaves_per_dir = 10;
+
+    std::cerr << "Making " << files << " files under " << root << "...\n";
+    for (std::size_t i = 0; i < files; ++i) {
+        auto const leaf = i / files_per_leaf;
+        auto const dir = root / ("d" + std::to_string(leaf / leaves_per_dir)) / ("l" + std::to_string(leaf % leaves_per_dir));
+        if (i % files_per_leaf == 0) {
+            fs::create_directories(dir);
+            // one symlink that is output (to a file in the same directory) and one that isn't (to the parent)...
+            fs::create_directory_symlink("..", dir / "up");
+        }
+        std::ofstream{ dir / ("f" + std::to_string(i)) };
+        if (i % files_per_leaf == 1)
+            fs::create_symlink("f" + std::to_string(i), dir / "same");
+    }
+}
+
+struct scan_result {
+    std::size_t paths = 0;
+    double seconds = 0;
+    std::size_t result_bytes = 0;
+};
+
+std::size_t result_bytes(fs::path const& p) {
+    return sizeof p + (p.native().capacity() + 1) * sizeof(fs::path::value_type);
+}
+
+std::size_t result_bytes(path_handle const& h) {
+    return sizeof h;
+}
+
+std::size_t result_bytes(scan_record const& r) {
+    return sizeof r + (r.path.native().capacity() + 1) * sizeof(fs::path::value_type);
+}
+
+// the metadata scanners' baseline: bfs_scan() with one blocking stat per file...
+std::generator<scan_record> bfs_scan_with_stat(fs::path root) {
+    for (auto const& p : bfs_scan(root)) {
+        scan_record record{ p, stat_file(p) };
+        co_yield std::move(record);
+    }
+}
+
+// runs the scan twice and returns the path count and the seconds of the second run...
+template <typename MakeScan>
+scan_result time_scan(MakeScan make_scan) {
+    scan_result r;
+    for (int run = 0; run < 2; ++run) {
+        r = {};
+        auto const t0 = std::chrono::steady_clock::now();
+        for (auto const& p : make_scan()) {
+            ++r.paths;
+            r.result_bytes += result_bytes(p);
+        }
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    fs::path const root = argc > 1 ? argv[1] : "scan_bench_tree";
+    std::size_t const files = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+
+    if (!fs::exists(root))
+        make_tree(root, files);
+
+    std::size_t expected = 0;
+    bool ok = true;
+    auto report = [&](char const* scanner, unsigned threads, scan_result const& r) {
+        if (expected == 0)
+            expected = r.paths;
+        else if (r.paths != expected) {
+            std::cerr << "ERROR: " << scanner << " output " << r.paths << " paths, bfs_scan() output " << expected << "\n";
+            ok = false;
+        }
+        std::println("{},{},{},{:.6f},{:.0f},{}", scanner, threads, r.paths, r.seconds, r.paths / r.seconds, r.result_bytes);
+    };
+
+    std::println("scanner,threads,paths,seconds,paths_per_sec,result_bytes");
+    report("bfs_scan", 1, time_scan([&] { return bfs_scan(root); }));
+    report("getdents_bfs_scan", 1, time_scan([&] { return getdents_bfs_scan(root); }));
+    report("getdents_bfs_scan<dfs_frontier>", 1, time_scan([&] { return getdents_bfs_scan<dfs_frontier>(root); }));
+    report("getdents_bfs_scan<hybrid_frontier>", 1, time_scan([&] { return getdents_bfs_scan<hybrid_frontier>(root); }));
+
+    path_arena arena;
+    auto r = time_scan([&] { arena.clear(); return arena_bfs_scan(root, arena, scan_backend::getdents); });
+    r.result_bytes += arena.memory_bytes();
+    report("arena_bfs_scan+getdents", 1, r);
+
+    report("bfs_scan+stat", 1, time_scan([&] { return bfs_scan_with_stat(root); }));
+    metadata_scan_options mopts;
+    // (without io_uring metadata_bfs_scan() would quietly time its thread pool again)
+    if (metadata_io_uring_available(mopts.queue_depth))
+        report("metadata_bfs_scan+io_uring", 1, time_scan([&] { return metadata_bfs_scan(root, mopts); }));
+    else
+        std::cerr << "io_uring isn't available, skipping metadata_bfs_scan+io_uring\n";
+    mopts.use_io_uring = false;
+    report("metadata_bfs_scan+pool", std::max(1u, std::thread::hardware_concurrency()), time_scan([&] { return metadata_bfs_scan(root, mopts); }));
+
+    unsigned const hw = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 2; threads <= 2 * hw; threads *= 2) {
+        for (auto const backend : { scan_backend::iterator, scan_backend::getdents }) {
+            parallel_scan_options opts;
+            opts.threads = threads;
+            opts.backend = backend;
+            report(backend == scan_backend::getdents ? "parallel_bfs_scan+getdents" : "parallel_bfs_scan",
+                   threads, time_scan([&] { return parallel_bfs_scan(root, opts); }));
+        }
+    }
+
+    return ok ? 0 : 1;
+}
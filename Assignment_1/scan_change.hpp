@@ -0,0 +1,32 @@
+#ifndef include_scan_change_hpp_
+#define include_scan_change_hpp_
+
+#include <filesystem>
+
+// A change to the set of paths bfs_scan() would output (see incremental_scan.hpp and watch_scan.hpp).
+// A move inside a watched tree is a moved_from of the old path and a moved_to of the new one. For
+// keeping a set of paths up to date moved_from is the same as removed and moved_to as added.
+enum class change_kind {
+    added,
+    removed,
+    moved_from,
+    moved_to
+};
+
+struct scan_change {
+    change_kind kind;
+    std::filesystem::path path;
+};
+
+// the prefix a01 outputs before a changed path...
+inline char const* change_prefix(change_kind kind) noexcept {
+    switch (kind) {
+        case change_kind::added:      return "+ ";
+        case change_kind::removed:    return "- ";
+        case change_kind::moved_from: return "< ";
+        case change_kind::moved_to:   return "> ";
+    }
+    return "? ";
+}
+
+#endif // include_scan_change_hpp_
@@ -0,0 +1,145 @@
+#ifndef include_scan_entry_hpp_
+#define include_scan_entry_hpp_
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__)
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+
+// closes a file descriptor when it goes out of scope...
+class unique_fd {
+    int fd_;
+public:
+    explicit unique_fd(int fd) noexcept : fd_{fd} {}
+    unique_fd(unique_fd const&) = delete;
+    unique_fd& operator=(unique_fd const&) = delete;
+    ~unique_fd() { if (fd_ >= 0) ::close(fd_); }
+    int get() const noexcept { return fd_; }
+};
+
+#endif // defined(__linux__)
+
+// symlink_resolver answers "does this symlink resolve to a direct child of dir?" for the symlinks of one
+// directory (i.e., one is made per directory read, and every directory is read once per scan).
+//
+// The straightforward way costs two fs::canonical() calls per symlink, each walking and readlink()ing
+// the whole path, one of them re-resolving dir itself every time. Instead:
+//   * on Linux a link whose target is a plain name (e.g., "link -> file") is resolved with one
+//     readlinkat() and one fstatat() relative to the directory's fd: if the target exists and is not
+//     itself a symlink, the link resolves to dir/target, which is a direct child of dir.
+//   * anything else (absolute targets, "..", chains of links, other systems) takes one fs::canonical()
+//     of the link and compares its parent with fs::canonical(dir), which is worked out at most once.
+// Errors are thrown as filesystem_errors just like fs::canonical() so callers can ignore the link.
+class symlink_resolver {
+    std::filesystem::path const& dir_;
+    std::optional<std::filesystem::path> canonical_dir_;
+#if defined(__linux__)
+    int dirfd_;                          // -1 until needed (unless the caller has the directory open)
+    std::optional<unique_fd> owned_fd_;
+#endif
+
+public:
+#if defined(__linux__)
+    explicit symlink_resolver(std::filesystem::path const& dir, int dirfd = -1) : dir_{dir}, dirfd_{dirfd} {}
+#else
+    explicit symlink_resolver(std::filesystem::path const& dir, int = -1) : dir_{dir} {}
+#endif
+
+    std::filesystem::path const& dir() const noexcept { return dir_; }
+
+    bool is_direct_child(std::filesystem::path const& link) {
+        namespace fs = std::filesystem;
+
+#if defined(__linux__)
+        if (dirfd_ < 0 && !owned_fd_) {
+            owned_fd_.emplace(::openat(AT_FDCWD, dir_.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC));
+            dirfd_ = owned_fd_->get();
+        }
+        if (dirfd_ >= 0) {
+            char target[PATH_MAX];
+            auto const n = ::readlinkat(dirfd_, link.filename().c_str(), target, sizeof target);
+            if (n > 0 && static_cast<std::size_t>(n) < sizeof target) {
+                std::string_view const t{ target, static_cast<std::size_t>(n) };
+                if (t.find('/') == std::string_view::npos && t != "." && t != "..") {
+                    target[n] = '\0';
+                    struct stat st;
+                    if (::fstatat(dirfd_, target, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                        throw fs::filesystem_error("cannot resolve symlink", link, std::error_code(errno, std::generic_category()));
+                    if (!S_ISLNK(st.st_mode))
+                        return true;
+                    // a link to a link: let canonical() follow the chain...
+                }
+            }
+        }
+#endif
+
+        auto cpath{ fs::canonical(link) };
+        // cpath is constructed by fs::canonical which converts a path into its absolute, normalized, symlink resolved form,
+        //      so path comparisons reflect the real filesystem
+
+        // consider a path that does not have a parent path to be under dir...
+        if (not cpath.has_parent_path()) // basically if cpath doesnt have a parent, then it is the root
+            return true;
+        // otherwise ensure the link's parent path is dir and use canonical() to determine this...
+        if (!canonical_dir_)
+            canonical_dir_ = fs::canonical(dir_);
+        return cpath.parent_path() == *canonical_dir_;
+    }
+};
+
+// What a scan does with one directory entry. Every scanner (sequential or parallel) goes through
+// classify_entry() so they all output the same set of paths.
+enum class entry_action {
+    skip,    // not output and not descended into
+    yield,   // output the entry's path
+    descend  // a real directory: scan it later
+};
+
+inline entry_action classify_entry(std::filesystem::directory_entry const& directory_entry, symlink_resolver& cur) {
+    // If current entry is a symbolic link and still points to a child directory under our current parent directory --> cur
+    if (directory_entry.is_symlink()) {
+        // Try Catch since canonical was giving filesystem error for symlink "link3" which was a file not a directory
+        try {
+            if (cur.is_direct_child(directory_entry.path()))
+                return entry_action::yield;
+        }
+        catch (const std::exception& e) {
+            // ignore this file and move on
+        }
+        return entry_action::skip;
+    }
+
+    auto const type = directory_entry.status().type();
+    if (type == std::filesystem::file_type::directory) // if true directory
+        return entry_action::descend;
+    if (type == std::filesystem::file_type::regular)
+        return entry_action::yield;
+    return entry_action::skip;
+}
+
+// Reads one whole directory with std::filesystem::directory_iterator: the paths to output go to files
+// and the directories to scan go to subdirs (both in directory order)...
+inline void read_directory_std(std::filesystem::path const& dir, std::vector<std::filesystem::path>& files, std::vector<std::filesystem::path>& subdirs) {
+    symlink_resolver links{ dir };
+    for (auto const& directory_entry : std::filesystem::directory_iterator{dir}) {
+        switch (classify_entry(directory_entry, links)) {
+            case entry_action::yield:   files.push_back(directory_entry.path()); break;
+            case entry_action::descend: subdirs.push_back(directory_entry.path()); break;
+            case entry_action::skip:    break;
+        }
+    }
+}
+
+#endif // include_scan_entry_hpp_
@@ -0,0 +1,167 @@
+#ifndef include_scan_filter_hpp_
+#define include_scan_filter_hpp_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+// glob_match() matches a whole name against a shell-style pattern: * is any run of characters and
+// ? is any one character (e.g., "node_modules", ".git", "*.o", "build-*")...
+inline bool glob_match(std::string_view pattern, std::string_view name) {
+    std::size_t p = 0, n = 0;
+    std::size_t star = std::string_view::npos, star_n = 0;   // where to retry after the last *
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        }
+        else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_n = n;
+        }
+        else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_n;
+        }
+        else
+            return false;
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+        ++p;
+    return p == pattern.size();
+}
+
+// the device a path is on (0 if unknown) so scans can stay on one filesystem...
+inline std::uintmax_t device_of(std::filesystem::path const& p) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat st;
+    if (::lstat(p.c_str(), &st) == 0)
+        return static_cast<std::uintmax_t>(st.st_dev);
+#else
+    (void)p;
+#endif
+    return 0;
+}
+
+// scan_filter is evaluated inside the scanners (not on their output) so a pruned directory is never
+// opened and a file that is filtered out is never output. Depths count from the scanned path: its
+// entries are at depth 1. The default scan_filter keeps everything.
+//
+// Directory pruning:
+//   exclude          entries (directories and files) whose name matches one of these globs are skipped
+//   max_depth        entries (files too) deeper than this are not output (so directories at max_depth
+//                    aren't read), e.g., 0 outputs nothing
+//   same_filesystem  directories on another filesystem than the scanned path are not read
+// File filtering (only files that pass all of them are output):
+//   extensions       e.g., ".cpp" (empty means any)
+//   min_size, max_size  in bytes, inclusive
+//   newer_than, older_than  last write time
+struct scan_filter {
+    std::vector<std::string> exclude;
+    std::optional<std::size_t> max_depth;
+    bool same_filesystem = false;
+
+    std::vector<std::string> extensions;
+    std::optional<std::uintmax_t> min_size;
+    std::optional<std::uintmax_t> max_size;
+    std::optional<std::filesystem::file_time_type> newer_than;
+    std::optional<std::filesystem::file_time_type> older_than;
+
+    bool excluded(std::filesystem::path const& p) const {
+        if (exclude.empty())
+            return false;
+        auto const name{ p.filename().string() };
+        return std::ranges::any_of(exclude, [&](std::string const& glob) { return glob_match(glob, name); });
+    }
+
+    // the device scans compare directories with when same_filesystem is set...
+    std::uintmax_t root_device(std::filesystem::path const& root) const {
+        return same_filesystem ? device_of(root) : 0;
+    }
+
+    // are entries at depth within max_depth?
+    bool keep_depth(std::size_t depth) const {
+        return !max_depth || depth <= *max_depth;
+    }
+
+    // should the directory dir (at depth) be read?
+    bool keep_directory(std::filesystem::path const& dir, std::size_t depth, std::uintmax_t root_dev) const {
+        if (max_depth && depth >= *max_depth)
+            return false;
+        if (excluded(dir))
+            return false;
+        return !same_filesystem || device_of(dir) == root_dev;
+    }
+
+    // the file checks that only need the name...
+    bool keep_name(std::filesystem::path const& p) const {
+        if (excluded(p))
+            return false;
+        return extensions.empty() || std::ranges::find(extensions, p.extension().string()) != extensions.end();
+    }
+
+    bool has_attribute_filters() const {
+        return min_size || max_size || newer_than || older_than;
+    }
+
+    // false for the default scan_filter (which keeps everything)...
+    bool active() const {
+        return !exclude.empty() || max_depth || same_filesystem || !extensions.empty() || has_attribute_filters();
+    }
+
+    // the file checks that need its size and last write time (only the ones that are set are looked at)...
+    bool keep_attributes(std::uintmax_t size, std::filesystem::file_time_type mtime) const {
+        if ((min_size && size < *min_size) || (max_size && size > *max_size))
+            return false;
+        return !(newer_than && mtime <= *newer_than) && !(older_than && mtime >= *older_than);
+    }
+
+    // should the file p (at depth) be output? (only stats the file when a size or time filter is set)
+    bool keep_file(std::filesystem::path const& p, std::size_t depth) const {
+        namespace fs = std::filesystem;
+
+        if (!keep_depth(depth) || !keep_name(p))
+            return false;
+
+        std::error_code ec;
+        std::uintmax_t size = 0;
+        fs::file_time_type mtime{};
+        if (min_size || max_size) {
+            size = fs::file_size(p, ec);
+            if (ec)
+                return false;
+        }
+        if (newer_than || older_than) {
+            mtime = fs::last_write_time(p, ec);
+            if (ec)
+                return false;
+        }
+        return keep_attributes(size, mtime);
+    }
+
+    // applies the filter to one directory's result (see read_directory()) whose entries are at depth
+    // (with_attributes == false leaves the size and time checks to a caller that stats the files anyway)...
+    void apply(std::vector<std::filesystem::path>& files, std::vector<std::filesystem::path>& subdirs, std::size_t depth, std::uintmax_t root_dev, bool with_attributes = true) const {
+        if (!keep_depth(depth))
+            files.clear();
+        else if (with_attributes && has_attribute_filters())
+            std::erase_if(files, [&](std::filesystem::path const& p) { return !keep_file(p, depth); });
+        else if (!exclude.empty() || !extensions.empty())
+            std::erase_if(files, [&](std::filesystem::path const& p) { return !keep_name(p); });
+        if (!exclude.empty() || max_depth || same_filesystem)
+            std::erase_if(subdirs, [&](std::filesystem::path const& d) { return !keep_directory(d, depth, root_dev); });
+    }
+};
+
+#endif // include_scan_filter_hpp_
@@ -0,0 +1,136 @@
+#ifndef include_scan_frontier_hpp_
+#define include_scan_frontier_hpp_
+
+#include <concepts>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+// A scan's frontier holds the directories it has found but not read yet (each with its depth, the root
+// is at depth 0). Which one pop() returns decides the traversal order, so the scanners take the frontier
+// as a policy (template) parameter:
+//   bfs_frontier     FIFO: breadth first, the original bfs_scan() order. Holds a whole level of the tree.
+//   dfs_frontier     LIFO: depth first. Holds the not yet read subdirectories of each directory on the
+//                    current path, i.e., it grows with the sum of their fan-outs (a directory's
+//                    subdirectories are all pushed when it is read) but not with the tree's width
+//                    elsewhere. (Subdirectories come out in reverse.)
+//   hybrid_frontier  breadth first until the frontier takes more than byte_budget bytes, then depth first
+//                    until it has shrunk to half of that.
+//
+// The directories are kept as path strings and only made into a std::filesystem::path when popped (a
+// path also allocates a list of its components, e.g., libstdc++'s is several times the string's size)
+// so bytes() (the entries and their strings) is the memory the pending directories really take, apart
+// from the container's spare room.
+using frontier_entry = std::pair<std::filesystem::path, std::size_t>;
+
+template <typename F>
+concept scan_frontier_c = requires(F f, F const cf, std::filesystem::path p, std::size_t depth) {
+    f.push(p, depth);
+    { f.pop() } -> std::same_as<frontier_entry>;
+    { cf.empty() } -> std::convertible_to<bool>;
+    { cf.bytes() } -> std::convertible_to<std::size_t>;
+};
+
+// how the frontiers store a directory...
+using pending_directory = std::pair<std::filesystem::path::string_type, std::size_t>;
+
+// the memory an entry holds (its string's buffer counts when it is not stored inside the string)...
+inline std::size_t pending_directory_bytes(pending_directory const& d) noexcept {
+    using string_type = std::filesystem::path::string_type;
+    static std::size_t const inline_capacity = string_type{}.capacity();
+    auto const capacity = d.first.capacity();
+    return sizeof(pending_directory) + (capacity > inline_capacity ? (capacity + 1) * sizeof(string_type::value_type) : 0);
+}
+
+inline frontier_entry make_frontier_entry(pending_directory&& d) {
+    return { std::filesystem::path(std::move(d.first)), d.second };
+}
+
+class bfs_frontier {
+    std::deque<pending_directory> pending_;
+    std::size_t bytes_ = 0;
+
+public:
+    bool empty() const noexcept { return pending_.empty(); }
+    std::size_t bytes() const noexcept { return bytes_; }
+
+    void push(std::filesystem::path const& dir, std::size_t depth) {
+        pending_.emplace_back(dir.native(), depth);
+        bytes_ += pending_directory_bytes(pending_.back());
+    }
+
+    frontier_entry pop() {
+        bytes_ -= pending_directory_bytes(pending_.front());
+        auto e{ make_frontier_entry(std::move(pending_.front())) };
+        pending_.pop_front();
+        return e;
+    }
+};
+
+class dfs_frontier {
+    std::vector<pending_directory> pending_;
+    std::size_t bytes_ = 0;
+
+public:
+    bool empty() const noexcept { return pending_.empty(); }
+    std::size_t bytes() const noexcept { return bytes_; }
+
+    void push(std::filesystem::path const& dir, std::size_t depth) {
+        pending_.emplace_back(dir.native(), depth);
+        bytes_ += pending_directory_bytes(pending_.back());
+    }
+
+    frontier_entry pop() {
+        bytes_ -= pending_directory_bytes(pending_.back());
+        auto e{ make_frontier_entry(std::move(pending_.back())) };
+        pending_.pop_back();
+        return e;
+    }
+};
+
+class hybrid_frontier {
+public:
+    static constexpr std::size_t default_byte_budget = 64 << 20;
+
+private:
+    std::deque<pending_directory> pending_;
+    std::size_t bytes_ = 0;
+    std::size_t budget_ = default_byte_budget;
+    bool depth_first_ = false;
+
+public:
+    hybrid_frontier() = default;
+    explicit hybrid_frontier(std::size_t byte_budget) noexcept : budget_{byte_budget} {}
+
+    bool empty() const noexcept { return pending_.empty(); }
+    std::size_t bytes() const noexcept { return bytes_; }
+    bool depth_first() const noexcept { return depth_first_; }
+
+    void push(std::filesystem::path const& dir, std::size_t depth) {
+        pending_.emplace_back(dir.native(), depth);
+        bytes_ += pending_directory_bytes(pending_.back());
+    }
+
+    // NOTE: the budget is not a hard limit: going depth first stops the frontier growing by a whole level
+    // at a time but it still grows by the fan-outs along the current path (see dfs_frontier)...
+    frontier_entry pop() {
+        // (half the budget in between so it doesn't flip back and forth at the budget)
+        if (bytes_ > budget_)
+            depth_first_ = true;
+        else if (bytes_ <= budget_ / 2)
+            depth_first_ = false;
+
+        auto& next = depth_first_ ? pending_.back() : pending_.front();
+        bytes_ -= pending_directory_bytes(next);
+        auto e{ make_frontier_entry(std::move(next)) };
+        if (depth_first_)
+            pending_.pop_back();
+        else
+            pending_.pop_front();
+        return e;
+    }
+};
+
+#endif // include_scan_frontier_hpp_
@@ -0,0 +1,277 @@
+#ifndef include_watch_scan_hpp_
+#define include_watch_scan_hpp_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <generator>
+#include <iterator>
+#include <queue>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "bfs_scan.hpp"
+#include "dirent_reader.hpp"
+#include "scan_change.hpp"
+#include "scan_entry.hpp"
+
+// watch_bfs_scan() first outputs every path bfs_scan() would as added and then keeps going: each
+// directory it reads gets an inotify watch so it outputs the changes to that set of paths as they
+// happen (added, removed, moved_from and moved_to, see scan_change.hpp) without ever rescanning.
+//
+//   * a directory that is created or moved in is watched and read (its paths are added/moved_to);
+//     its watch goes on before it is read so nothing created in between is missed.
+//   * a directory that is deleted or moved out takes everything under it with it (removed/moved_from).
+//   * if the inotify queue overflows (events were lost) the whole tree is read again and only the
+//     differences are output.
+//
+// It only ends when stoken is stopped or when root_path itself is deleted or moved (after outputting
+// every remaining path as removed). A symlink is judged (see classify_entry()) when it appears, not
+// again when its target changes. The directories' names are kept in memory (one watch each, see
+// /proc/sys/fs/inotify/max_user_watches). On systems without inotify only the initial scan is output.
+inline std::generator<scan_change> watch_bfs_scan(std::filesystem::path root_path, std::stop_token stoken = {}) {
+    namespace fs = std::filesystem;
+
+#if !defined(__linux__)
+    for (auto const& p : bfs_scan(root_path)) {
+        scan_change change{ change_kind::added, p };
+        co_yield std::move(change);
+    }
+#else
+    struct watched_dir {
+        fs::path path;
+        std::set<std::string> files;     // names of the entries bfs_scan() outputs
+        std::set<std::string> subdirs;
+    };
+
+    unique_fd const inotify_fd{ ::inotify_init1(IN_CLOEXEC) };
+    if (inotify_fd.get() < 0)
+        throw std::system_error(errno, std::generic_category(), "inotify_init1");
+
+    // stopping stoken wakes up the poll() below...
+    unique_fd const stop_fd{ ::eventfd(0, EFD_CLOEXEC) };
+    if (stop_fd.get() < 0)
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    std::stop_callback const on_stop{ stoken, [&stop_fd] {
+        std::uint64_t const one = 1;
+        [[maybe_unused]] auto const r = ::write(stop_fd.get(), &one, sizeof one);
+    } };
+
+    constexpr std::uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+    std::unordered_map<int, watched_dir> dirs;   // by watch descriptor
+    std::unordered_map<fs::path::string_type, int> wd_of;
+
+    // stops watching dir and everything under it and outputs their paths as kind...
+    auto forget = [&](fs::path dir, change_kind kind) -> std::generator<scan_change> {
+        std::vector<fs::path> stack{ std::move(dir) };
+        while (!stack.empty()) {
+            auto const d = std::move(stack.back());
+            stack.pop_back();
+            auto const it = wd_of.find(d.native());
+            if (it == wd_of.end())
+                continue;
+            int const wd = it->second;
+            wd_of.erase(it);
+            auto const node = std::move(dirs.at(wd));
+            dirs.erase(wd);
+            ::inotify_rm_watch(inotify_fd.get(), wd);
+
+            for (auto const& name : node.files) {
+                scan_change change{ kind, d / name };
+                co_yield std::move(change);
+            }
+            for (auto const& name : node.subdirs)
+                stack.push_back(d / name);
+        }
+    };
+
+    // watches and reads top and everything under it in BFS order: paths that aren't known yet are output
+    // as kind and known ones that are gone as removed...
+    auto sync = [&](fs::path top, change_kind kind) -> std::generator<scan_change> {
+        std::queue<fs::path> path_chain;
+        path_chain.push(std::move(top));
+        std::vector<fs::path> files, subdirs;
+        while (!path_chain.empty()) {
+            auto const cur = std::move(path_chain.front());
+            path_chain.pop();
+            bool const is_root = cur == root_path;
+
+            int wd = ::inotify_add_watch(inotify_fd.get(), cur.c_str(), is_root ? watch_mask : watch_mask | IN_DONT_FOLLOW);
+            if (wd < 0) {
+                std::error_code const ec(errno, std::generic_category());
+                if (is_root)
+                    throw fs::filesystem_error("directory iterator cannot open directory", cur, ec);
+                if (ec == std::errc::no_such_file_or_directory || ec == std::errc::not_a_directory)
+                    continue;   // already gone again (its parent's events say so)
+                throw fs::filesystem_error("cannot watch directory", cur, ec);
+            }
+            // the same directory under another path (i.e., it was moved and that event wasn't seen yet)...
+            if (auto const it = dirs.find(wd); it != dirs.end() && it->second.path != cur) {
+                for (auto&& change : forget(it->second.path, change_kind::moved_from))
+                    co_yield std::move(change);
+                wd = ::inotify_add_watch(inotify_fd.get(), cur.c_str(), is_root ? watch_mask : watch_mask | IN_DONT_FOLLOW);
+                if (wd < 0)
+                    continue;
+            }
+            auto& node = dirs[wd];
+            node.path = cur;
+            wd_of[cur.native()] = wd;
+
+            files.clear();
+            subdirs.clear();
+            try {
+                read_directory(scan_backend::getdents, cur, files, subdirs);
+            }
+            catch (fs::filesystem_error const&) {
+                if (is_root)
+                    throw;
+                continue;   // deleted while being read: its events will follow
+            }
+
+            std::set<std::string> present;
+            for (auto const& f : files) {
+                auto name{ f.filename().string() };
+                if (node.files.insert(name).second) {
+                    scan_change change{ kind, f };
+                    co_yield std::move(change);
+                }
+                present.insert(std::move(name));
+            }
+            for (auto it = node.files.begin(); it != node.files.end(); ) {
+                if (present.contains(*it)) {
+                    ++it;
+                    continue;
+                }
+                scan_change change{ change_kind::removed, cur / *it };
+                it = node.files.erase(it);
+                co_yield std::move(change);
+            }
+
+            present.clear();
+            for (auto& d : subdirs) {
+                auto name{ d.filename().string() };
+                node.subdirs.insert(name);
+                present.insert(std::move(name));
+                path_chain.push(std::move(d));   // known ones too since after an overflow anything under them may have changed
+            }
+            std::vector<std::string> gone;
+            std::ranges::copy_if(node.subdirs, std::back_inserter(gone), [&](std::string const& name) { return !present.contains(name); });
+            for (auto const& name : gone) {
+                node.subdirs.erase(name);
+                for (auto&& change : forget(cur / name, change_kind::removed))
+                    co_yield std::move(change);
+            }
+        }
+    };
+
+    for (auto&& change : sync(root_path, change_kind::added))
+        co_yield std::move(change);
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    pollfd fds[2] = { { inotify_fd.get(), POLLIN, 0 }, { stop_fd.get(), POLLIN, 0 } };
+    while (!stoken.stop_requested()) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
+        if (fds[1].revents != 0)
+            break;
+
+        auto const n = ::read(inotify_fd.get(), buffer, sizeof buffer);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "read inotify events");
+        }
+
+        for (ssize_t offset = 0; offset < n; ) {
+            auto const* const event = reinterpret_cast<inotify_event const*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (auto&& change : sync(root_path, change_kind::added))
+                    co_yield std::move(change);
+                continue;
+            }
+
+            auto const it = dirs.find(event->wd);
+            if (it == dirs.end())
+                continue;   // a watch that was already forgotten
+            auto const dir{ it->second.path };   // (a copy since the node can go away while yielding)
+
+            // the watched directory itself is gone: the root ends the scan, others are also reported to their parent...
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                if (dir == root_path) {
+                    for (auto&& change : forget(dir, change_kind::removed))
+                        co_yield std::move(change);
+                    co_return;
+                }
+                if (event->mask & IN_IGNORED)
+                    for (auto&& change : forget(dir, change_kind::removed))
+                        co_yield std::move(change);
+                continue;
+            }
+            if (event->len == 0)
+                continue;
+
+            std::string const name{ event->name };
+            bool const is_dir = event->mask & IN_ISDIR;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                auto const kind = event->mask & IN_MOVED_TO ? change_kind::moved_to : change_kind::added;
+                if (is_dir) {
+                    it->second.subdirs.insert(name);
+                    for (auto&& change : sync(dir / name, kind))
+                        co_yield std::move(change);
+                    continue;
+                }
+
+                // the same rule as bfs_scan() (e.g., only symlinks to direct children are output)...
+                auto const path{ dir / name };
+                bool output = false;
+                try {
+                    std::error_code ec;
+                    fs::directory_entry const entry{ path, ec };
+                    symlink_resolver links{ dir };
+                    output = !ec && classify_entry(entry, links) == entry_action::yield;
+                }
+                catch (std::exception const&) {
+                }
+                if (output && it->second.files.insert(name).second) {
+                    scan_change change{ kind, path };
+                    co_yield std::move(change);
+                }
+            }
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                auto const kind = event->mask & IN_MOVED_FROM ? change_kind::moved_from : change_kind::removed;
+                if (is_dir) {
+                    it->second.subdirs.erase(name);
+                    for (auto&& change : forget(dir / name, kind))
+                        co_yield std::move(change);
+                }
+                else if (it->second.files.erase(name) != 0) {
+                    scan_change change{ kind, dir / name };
+                    co_yield std::move(change);
+                }
+            }
+        }
+    }
+#endif
+    co_return;
+}
+
+#endif // include_watch_scan_hpp_
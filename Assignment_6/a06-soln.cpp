@@ -7,13 +7,37 @@
 #include <syncstream>
 #include <thread>
 
+#include "concurrent_priority_queue.hpp"
 #include "concurrent_queue.hpp"
 #include "cq_concepts.hpp"
+#include "mpmc_queue.hpp"
+#include "sharded_concurrent_queue.hpp"
+#include "spsc_queue.hpp"
 
+using comp3400_2026w::concurrent_deadline_queue;
+using comp3400_2026w::concurrent_priority_queue;
 using comp3400_2026w::concurrent_queue;
+using comp3400_2026w::mpmc_queue;
+using comp3400_2026w::sharded_concurrent_queue;
+using comp3400_2026w::spsc_queue;
+
+using comp3400_2026w::basic_concurrent_queue_c;
+using comp3400_2026w::blocking_concurrent_queue_c;
+using comp3400_2026w::bounded_concurrent_queue_c;
 using comp3400_2026w::concurrent_queue_c;
+using comp3400_2026w::fixed_capacity_concurrent_queue_c;
+using comp3400_2026w::priority_concurrent_queue_c;
+using comp3400_2026w::spsc_concurrent_queue_c;
 
 static_assert(concurrent_queue_c<concurrent_queue<int>>);
+static_assert(basic_concurrent_queue_c<concurrent_queue<int>>);
+static_assert(blocking_concurrent_queue_c<concurrent_queue<int>>);
+static_assert(bounded_concurrent_queue_c<concurrent_queue<int>>);
+static_assert(spsc_concurrent_queue_c<spsc_queue<int>>);
+static_assert(fixed_capacity_concurrent_queue_c<mpmc_queue<int>>);
+static_assert(basic_concurrent_queue_c<sharded_concurrent_queue<int>>);
+static_assert(priority_concurrent_queue_c<concurrent_priority_queue<int>>);
+static_assert(priority_concurrent_queue_c<concurrent_deadline_queue<int>>);
 
 comp3400_2026w::concurrent_queue<int> cq;
 
@@ -66,6 +90,27 @@ void do_something()
   all_work_is_done.arrive_and_wait();
 }
 
+// pipeline_demo() shuts a producer/consumer pipeline down with close():
+// the consumer drains whatever is left and its loop then ends (i.e., no
+// latches, timed polling or sentinel values are needed)...
+void pipeline_demo()
+{
+  using namespace std;
+
+  comp3400_2026w::concurrent_queue<int> pipe;
+
+  jthread consumer([&pipe] {
+    int sum{};
+    for (auto v : pipe.consume())
+      sum += v;
+    println("The consumer saw end-of-stream after summing to {}.", sum);
+  });
+
+  for (int i = 1; i <= 100; ++i)
+    pipe.push(i);
+  pipe.close();
+}
+
 int main()
 {
   using namespace std;
@@ -80,4 +125,6 @@ int main()
 
   // Output a message and quit...
   println("\n\nThere are {} elements remaining in the queue. They are: {}", cq.size(), cq);
+
+  pipeline_demo();
 }
@@ -0,0 +1,21 @@
+#ifndef include_cache_line_hpp_
+#define include_cache_line_hpp_
+
+#include <cstddef>
+
+namespace comp3400_2026w {
+
+// cache_line_size is the alignment used to keep atomics that are written by
+// different threads on different cache lines (i.e., to avoid false
+// sharing). NOTE: std::hardware_destructive_interference_size is not used
+// since GCC warns its value may change with -mtune (i.e., it is not ABI
+// stable) and Apple Silicon uses 128-byte lines.
+#if defined(__APPLE__) && defined(__aarch64__)
+inline constexpr std::size_t cache_line_size = 128;
+#else
+inline constexpr std::size_t cache_line_size = 64;
+#endif
+
+} // namespace comp3400_2026w
+
+#endif // include_cache_line_hpp_
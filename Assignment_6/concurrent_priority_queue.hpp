@@ -0,0 +1,617 @@
+#ifndef include_concurrent_priority_queue_hpp_
+#define include_concurrent_priority_queue_hpp_
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "concurrent_queue.hpp"
+
+namespace comp3400_2026w {
+
+// concurrent_priority_queue has the same thread-safe push/pop surface as
+// concurrent_queue but pop() returns the highest priority element (i.e.,
+// like std::priority_queue: with std::less the largest one comes first).
+// Elements of equal priority are popped in no particular order.
+//
+// The elements are kept in an Arity-ary heap in Container: a node's Arity
+// children are adjacent so a sift down compares them within one or two
+// cache lines and the heap is only log_Arity(n) levels deep.
+//
+// push_range() appends the whole range and then restores the heap by
+// sifting down only the ancestors of the new elements, bottom level
+// first (i.e., Floyd's bottom-up heap construction restricted to the
+// touched subtrees): O(k + log n) sifts for k new elements rather than
+// one O(log n) sift up per element.
+template <
+  typename T,
+  typename Compare = std::less<T>,
+  std::size_t Arity = 4,
+  typename Container = std::vector<T>
+>
+requires (Arity >= 2)
+class concurrent_priority_queue
+{
+  template <typename T2, typename Ch>
+  friend struct std::formatter;
+
+public:
+  using container_type = Container;
+  using value_compare = Compare;
+  using value_type = typename Container::value_type;
+  using size_type = typename Container::size_type;
+
+  static constexpr std::size_t arity = Arity;
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable_any not_empty_;
+  size_type waiting_consumers_{};
+  bool closed_{};
+
+  Container c_;
+  [[no_unique_address]] Compare comp_;
+
+  static constexpr size_type parent(size_type i) noexcept
+  {
+    return (i - 1) / Arity;
+  }
+
+  static constexpr size_type first_child(size_type i) noexcept
+  {
+    return i * Arity + 1;
+  }
+
+  // moves v into the hole at index i and then down to its place...
+  void sift_down_hole(size_type i, value_type v)
+  {
+    auto const n = c_.size();
+    for (;;)
+    {
+      auto const first = first_child(i);
+      if (first >= n)
+        break;
+
+      auto best = first;
+      auto const last = std::min(first + Arity, n);
+      for (auto j = first + 1; j < last; ++j)
+        if (comp_(c_[best], c_[j]))
+          best = j;
+
+      if (!comp_(v, c_[best]))
+        break;
+      c_[i] = std::move(c_[best]);
+      i = best;
+    }
+    c_[i] = std::move(v);
+  }
+
+  void sift_down(size_type i)
+  {
+    value_type v{std::move(c_[i])};
+    sift_down_hole(i, std::move(v));
+  }
+
+  void sift_up(size_type i)
+  {
+    value_type v{std::move(c_[i])};
+    while (i > 0)
+    {
+      auto const p = parent(i);
+      if (!comp_(c_[p], v))
+        break;
+      c_[i] = std::move(c_[p]);
+      i = p;
+    }
+    c_[i] = std::move(v);
+  }
+
+  // restores the heap after [old_size, size()) was appended to a heap...
+  void heapify_appended(size_type old_size)
+  {
+    auto const n = c_.size();
+    if (n - old_size == 1)
+    {
+      sift_up(old_size);
+      return;
+    }
+    if (n < 2 || n == old_size)
+      return;
+
+    // every ancestor of an appended element is (level by level) in
+    // [lo, hi], and each level must be done before the one above it...
+    auto lo = parent(std::max<size_type>(old_size, 1));
+    auto hi = parent(n - 1);
+    for (;;)
+    {
+      for (auto i = hi + 1; i-- > lo; )
+        sift_down(i);
+      if (lo == 0)
+        break;
+      lo = parent(lo);
+      hi = parent(hi);
+    }
+  }
+
+  // must be called with mutex_ held: appends r and restores the heap (also
+  // when an element's construction throws part way through)...
+  template <typename R>
+  size_type push_range_locked(R&& r)
+  {
+    auto const old_size = c_.size();
+    try
+    {
+      for (auto&& x : r)
+        c_.emplace_back(std::forward<decltype(x)>(x));
+    }
+    catch (...)
+    {
+      heapify_appended(old_size);
+      throw;
+    }
+    heapify_appended(old_size);
+    return c_.size() - old_size;
+  }
+
+  // must be called with mutex_ held and the queue non-empty...
+  value_type pop_top_locked()
+  {
+    value_type retval{std::move(c_.front())};
+    if (c_.size() > 1)
+    {
+      value_type last{std::move(c_.back())};
+      c_.pop_back();
+      sift_down_hole(0, std::move(last));
+    }
+    else
+      c_.pop_back();
+    return retval;
+  }
+
+  void notify_not_empty(size_type n = 1)
+  {
+    if (waiting_consumers_ == 0 || n == 0)
+      return;
+    if (n == 1)
+      not_empty_.notify_one();
+    else
+      not_empty_.notify_all();
+  }
+
+  template <typename Wait>
+  std::optional<value_type> wait_pop_impl(Wait&& wait)
+  {
+    std::unique_lock lk{mutex_};
+    if (c_.empty() && !closed_)
+    {
+      ++waiting_consumers_;
+      bool const ready = std::forward<Wait>(wait)(lk);
+      --waiting_consumers_;
+      if (!ready)
+        return std::nullopt;
+    }
+    if (c_.empty())
+      return std::nullopt;
+    return pop_top_locked();
+  }
+
+  auto ready_pred() noexcept
+  {
+    return [this] { return closed_ || !c_.empty(); };
+  }
+
+public:
+  concurrent_priority_queue() = default;
+
+  explicit concurrent_priority_queue(Compare const& comp) :
+    comp_{comp}
+  {
+  }
+
+  concurrent_priority_queue(Compare const& comp, Container const& c) :
+    c_{c},
+    comp_{comp}
+  {
+    heapify_appended(0);
+  }
+
+  concurrent_priority_queue(Compare const& comp, Container&& c) :
+    c_{std::move(c)},
+    comp_{comp}
+  {
+    heapify_appended(0);
+  }
+
+  template <typename InputIt>
+  requires compatible_input_iterator_c<InputIt, value_type>
+  concurrent_priority_queue(
+    InputIt first, InputIt last, Compare const& comp = Compare()
+  ) :
+    c_(first, last),
+    comp_{comp}
+  {
+    heapify_appended(0);
+  }
+
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  concurrent_priority_queue(
+    std::from_range_t, R&& r, Compare const& comp = Compare()
+  ) :
+    comp_{comp}
+  {
+    push_range_locked(std::forward<R>(r));
+  }
+
+  concurrent_priority_queue(concurrent_priority_queue const& other)
+  {
+    std::lock_guard lk{other.mutex_};
+    c_ = other.c_;
+    comp_ = other.comp_;
+  }
+
+  concurrent_priority_queue(concurrent_priority_queue&& other)
+  {
+    std::lock_guard lk{other.mutex_};
+    c_ = std::move(other.c_);
+    other.c_.clear();
+    comp_ = other.comp_;
+  }
+
+  concurrent_priority_queue& operator=(concurrent_priority_queue const& other)
+  {
+    if (this != std::addressof(other))
+    {
+      std::scoped_lock lk{mutex_, other.mutex_};
+      c_ = other.c_;
+      comp_ = other.comp_;
+      notify_not_empty(c_.size());
+    }
+    return *this;
+  }
+
+  concurrent_priority_queue& operator=(concurrent_priority_queue&& other)
+  {
+    if (this != std::addressof(other))
+    {
+      std::scoped_lock lk{mutex_, other.mutex_};
+      c_ = std::move(other.c_);
+      other.c_.clear();
+      comp_ = other.comp_;
+      notify_not_empty(c_.size());
+    }
+    return *this;
+  }
+
+  value_compare value_comp() const
+  {
+    return comp_;
+  }
+
+  // close() makes all further pushes fail and wakes every blocked consumer.
+  // Elements already queued can still be popped.
+  void close()
+  {
+    std::lock_guard lk{mutex_};
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+  bool is_closed() const
+  {
+    std::lock_guard lk{mutex_};
+    return closed_;
+  }
+
+  void clear()
+  {
+    // the elements are destroyed after the lock is released...
+    Container tmp;
+    std::lock_guard lk{mutex_};
+    using std::swap;
+    swap(tmp, c_);
+  }
+
+  // top() returns a copy of the element pop() would return next...
+  std::optional<value_type> top() const
+  {
+    std::lock_guard lk{mutex_};
+    if (!c_.empty())
+      return c_.front();
+    else
+      return std::nullopt;
+  }
+
+  bool empty() const
+  {
+    std::lock_guard lk{mutex_};
+    return c_.empty();
+  }
+
+  size_type size() const
+  {
+    std::lock_guard lk{mutex_};
+    return c_.size();
+  }
+
+  // push() and emplace() throw closed_queue_error once the queue is closed...
+  void push(value_type const& v)
+  {
+    emplace(v);
+  }
+
+  void push(value_type&& v)
+  {
+    emplace(std::move(v));
+  }
+
+  // the try_*() operations never block: they fail if the lock is busy or
+  // the queue is closed...
+  bool try_push(value_type const& v)
+  {
+    return try_emplace(v);
+  }
+
+  bool try_push(value_type&& v)
+  {
+    return try_emplace(std::move(v));
+  }
+
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  void push_range(R&& r)
+  {
+    std::lock_guard lk{mutex_};
+    if (closed_)
+      throw closed_queue_error{};
+    notify_not_empty(push_range_locked(std::forward<R>(r)));
+  }
+
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  bool try_push_range(R&& r)
+  {
+    std::unique_lock lk{mutex_, std::try_to_lock};
+    if (!lk || closed_)
+      return false;
+    notify_not_empty(push_range_locked(std::forward<R>(r)));
+    return true;
+  }
+
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    std::lock_guard lk{mutex_};
+    if (closed_)
+      throw closed_queue_error{};
+    c_.emplace_back(std::forward<Args>(args)...);
+    sift_up(c_.size() - 1);
+    notify_not_empty();
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    std::unique_lock lk{mutex_, std::try_to_lock};
+    if (!lk || closed_)
+      return false;
+    c_.emplace_back(std::forward<Args>(args)...);
+    sift_up(c_.size() - 1);
+    notify_not_empty();
+    return true;
+  }
+
+  std::optional<value_type> pop()
+  {
+    std::lock_guard lk{mutex_};
+    if (c_.empty())
+      return std::nullopt;
+    return pop_top_locked();
+  }
+
+  auto try_pop() -> std::tuple<bool, std::optional<value_type>>
+  {
+    std::unique_lock lk{mutex_, std::try_to_lock};
+    if (!lk)
+      return {false, std::nullopt};
+    if (c_.empty())
+      return {true, std::nullopt};
+    return {true, pop_top_locked()};
+  }
+
+  // wait_pop() blocks until an element is available and then pops it. It
+  // returns std::nullopt only if the queue is closed and drained.
+  std::optional<value_type> wait_pop()
+  {
+    return wait_pop_impl([this](std::unique_lock<std::mutex>& lk) {
+      not_empty_.wait(lk, ready_pred());
+      return true;
+    });
+  }
+
+  // wait_pop(stoken) also returns std::nullopt if stop is requested first...
+  std::optional<value_type> wait_pop(std::stop_token stoken)
+  {
+    return wait_pop_impl([&](std::unique_lock<std::mutex>& lk) {
+      return not_empty_.wait(lk, stoken, ready_pred());
+    });
+  }
+
+  // wait_pop_for() and wait_pop_until() also return std::nullopt on timeout...
+  template <typename Rep, typename Period>
+  std::optional<value_type> wait_pop_for(
+    std::chrono::duration<Rep, Period> const& rel_time
+  )
+  {
+    return wait_pop_impl([&](std::unique_lock<std::mutex>& lk) {
+      return not_empty_.wait_for(lk, rel_time, ready_pred());
+    });
+  }
+
+  template <typename Clock, typename Duration>
+  std::optional<value_type> wait_pop_until(
+    std::chrono::time_point<Clock, Duration> const& abs_time
+  )
+  {
+    return wait_pop_impl([&](std::unique_lock<std::mutex>& lk) {
+      return not_empty_.wait_until(lk, abs_time, ready_pred());
+    });
+  }
+
+  void swap(concurrent_priority_queue& other)
+  {
+    if (this == std::addressof(other))
+      return;
+
+    std::scoped_lock lk{mutex_, other.mutex_};
+    using std::swap;
+    swap(c_, other.c_);
+    swap(comp_, other.comp_);
+    notify_not_empty(c_.size());
+    other.notify_not_empty(other.c_.size());
+  }
+};
+
+template <typename T, typename Compare, std::size_t Arity, typename Container>
+inline void swap(
+  concurrent_priority_queue<T, Compare, Arity, Container>& a,
+  concurrent_priority_queue<T, Compare, Arity, Container>& b
+)
+{
+  a.swap(b);
+}
+
+//=============================================================================
+
+// deadline_item and earliest_deadline_first give concurrent_priority_queue
+// an earliest-deadline-first (EDF) mode: the item whose deadline is
+// soonest is popped first, e.g.,
+//
+//   concurrent_deadline_queue<job> q;
+//   q.emplace(std::chrono::steady_clock::now() + 5ms, job{...});
+template <typename T, typename Clock = std::chrono::steady_clock>
+struct deadline_item
+{
+  typename Clock::time_point deadline;
+  T value;
+};
+
+struct earliest_deadline_first
+{
+  template <typename T, typename Clock>
+  bool operator()(
+    deadline_item<T, Clock> const& a,
+    deadline_item<T, Clock> const& b
+  ) const noexcept
+  {
+    // the "largest" (i.e., first popped) item has the earliest deadline...
+    return b.deadline < a.deadline;
+  }
+};
+
+template <
+  typename T,
+  typename Clock = std::chrono::steady_clock,
+  std::size_t Arity = 4
+>
+using concurrent_deadline_queue = concurrent_priority_queue<
+  deadline_item<T, Clock>, earliest_deadline_first, Arity
+>;
+
+} // namespace comp3400_2026w
+
+//=============================================================================
+
+namespace std {
+
+// deadline_items format as their value (since most clocks' time_points are
+// not formattable)...
+template <typename T, typename Clock, typename Ch>
+requires std::formattable<T, Ch>
+struct formatter<comp3400_2026w::deadline_item<T, Clock>, Ch> :
+  formatter<T, Ch>
+{
+  template <typename FormatContext>
+  auto format(
+    comp3400_2026w::deadline_item<T, Clock> const& d,
+    FormatContext& ctx
+  ) const
+  {
+    return formatter<T, Ch>::format(d.value, ctx);
+  }
+};
+
+// formats the elements in pop order (i.e., highest priority first). The
+// heap is copied while holding the lock and is sorted and formatted after
+// releasing it...
+template <
+  typename Ch, typename T, typename Compare, std::size_t Arity,
+  typename Container
+>
+requires std::formattable<T, Ch>
+struct formatter<
+  comp3400_2026w::concurrent_priority_queue<T, Compare, Arity, Container>, Ch
+>
+{
+  constexpr auto parse(std::basic_format_parse_context<Ch>& ctx)
+  {
+    auto it = ctx.begin();
+    if (it != ctx.end() && *it != '}')
+      throw std::format_error(
+        "invalid format specifier for concurrent_priority_queue"
+      );
+    return it;
+  }
+
+  template <typename FormatContext>
+  auto format(
+    comp3400_2026w::concurrent_priority_queue<T, Compare, Arity, Container>
+      const& cpq,
+    FormatContext& ctx
+  ) const
+  {
+    auto [elems, comp] = [&] {
+      std::lock_guard lk{cpq.mutex_};
+      return std::pair{
+        std::vector<T>(std::ranges::begin(cpq.c_), std::ranges::end(cpq.c_)),
+        cpq.comp_
+      };
+    }();
+
+    auto out = ctx.out();
+    if (elems.empty())
+      return std::format_to(out, "<empty>");
+
+    std::ranges::sort(elems, [&](T const& a, T const& b) { return comp(b, a); });
+
+    bool first = true;
+    for (auto const& x : elems)
+    {
+      if (!first)
+        out = std::format_to(out, " ");
+      out = std::format_to(out, "{}", x);
+      first = false;
+    }
+
+    return out;
+  }
+};
+
+} // namespace std
+
+//=============================================================================
+
+#endif // include_concurrent_priority_queue_hpp_
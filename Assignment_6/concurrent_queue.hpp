@@ -1,18 +1,34 @@
 #ifndef include_concurrent_queue_hpp_
 #define include_concurrent_queue_hpp_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <compare>
 #include <concepts>
+#include <condition_variable>
+#include <coroutine>
 #include <deque>
+#include <expected>
 #include <format>
+#include <functional>
+#include <generator>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <ranges>
+#include <stdexcept>
+#include <stop_token>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "cq_stats.hpp"
 
 namespace comp3400_2026w {
 
@@ -26,7 +42,55 @@ concept compatible_input_range_c =
   std::ranges::input_range<R> &&
   std::convertible_to<std::ranges::range_value_t<R>, ValueType>;
 
-template <typename T, typename Container = std::deque<T>>
+// bounded is passed as the first constructor argument to give a queue a
+// fixed capacity, e.g., concurrent_queue<int> q{bounded, 1024}...
+struct bounded_t { explicit bounded_t() = default; };
+inline constexpr bounded_t bounded{};
+
+// closed_queue_error is thrown by the blocking push operations when the
+// queue has been closed...
+class closed_queue_error : public std::logic_error
+{
+public:
+  closed_queue_error() :
+    std::logic_error{"push on a closed concurrent_queue"}
+  {
+  }
+};
+
+// queue_status says why a concurrent_queue *_expected() pop did not
+// return an element...
+enum class queue_status
+{
+  empty,    // nothing is queued right now (but more may be pushed)
+  closed,   // the queue is closed and drained, i.e., end of stream
+  busy,     // try_pop_expected() found the lock held
+  timeout,  // wait_pop_expected_for/until() gave up waiting
+  stopped   // wait_pop_expected(stoken) had stop requested
+};
+
+// an async_executor_c is given the handle of a coroutine suspended in
+// concurrent_queue::async_pop() when it is ready to be resumed, e.g., to
+// post it to a thread pool...
+template <typename E>
+concept async_executor_c =
+  std::invocable<E&, std::coroutine_handle<>>;
+
+// inline_executor resumes the coroutine immediately on the thread that
+// made it ready (i.e., the pushing thread, after it released the lock)...
+struct inline_executor
+{
+  void operator()(std::coroutine_handle<> h) const
+  {
+    h.resume();
+  }
+};
+
+template <
+  typename T,
+  typename Container = std::deque<T>,
+  typename Stats = no_queue_stats
+>
 class concurrent_queue :
   protected std::queue<T, Container>
 {
@@ -41,9 +105,388 @@ public:
   using container_type = Container;
   using value_type = typename queue_type::value_type;
   using size_type = typename queue_type::size_type;
+  using stats_type = Stats;
+  using mutex_type = typename Stats::mutex_type;
+  using pop_result = std::expected<value_type, queue_status>;
+
+  static constexpr size_type unbounded = std::numeric_limits<size_type>::max();
 
 protected:
-  mutable std::mutex mutex_;
+  mutable mutex_type mutex_;
+  [[no_unique_address]] Stats stats_;
+
+  // consumers blocked in wait_pop*() park on not_empty_; waiting_consumers_
+  // (guarded by mutex_) lets producers skip the notify when nobody waits...
+  std::condition_variable_any not_empty_;
+  size_type waiting_consumers_{};
+
+  // producers blocked on a full bounded queue park on not_full_...
+  std::condition_variable_any not_full_;
+  size_type waiting_producers_{};
+
+  // coroutines suspended in async_pop() wait in an intrusive FIFO list
+  // (guarded by mutex_). Producers hand them elements directly and move
+  // them to the lock-free ready_ stack so that they are resumed only once
+  // mutex_ has been released (see async_resume_guard)...
+  struct async_waiter
+  {
+    async_waiter* next{};
+    std::optional<value_type> value;
+    std::coroutine_handle<> handle;
+    void (*schedule)(async_waiter&){};
+  };
+
+  async_waiter* async_head_{};
+  async_waiter* async_tail_{};
+  std::atomic<async_waiter*> ready_{};
+
+  // must be called with mutex_ held...
+  void make_ready(async_waiter& w)
+  {
+    w.next = ready_.load(std::memory_order_relaxed);
+    while (!ready_.compare_exchange_weak(
+             w.next, &w, std::memory_order_release, std::memory_order_relaxed
+           ))
+      ;
+  }
+
+  // must be called with mutex_ held: gives waiting coroutines an element
+  // each (or std::nullopt if closed) in FIFO order...
+  void serve_async_waiters()
+  {
+    while (async_head_ != nullptr && (closed_ || !inherited_queue::empty()))
+    {
+      auto* const w = async_head_;
+      async_head_ = w->next;
+      if (async_head_ == nullptr)
+        async_tail_ = nullptr;
+
+      if (!inherited_queue::empty())
+        w->value = pop_front_locked();
+      make_ready(*w);
+    }
+  }
+
+  // must be called WITHOUT mutex_ held...
+  void resume_ready_async_waiters()
+  {
+    if (ready_.load(std::memory_order_relaxed) == nullptr)
+      return;
+
+    // ready_ is a stack so reverse it to resume in FIFO order...
+    async_waiter* fifo{};
+    auto* w = ready_.exchange(nullptr, std::memory_order_acquire);
+    while (w != nullptr)
+    {
+      auto* const next = w->next;
+      w->next = fifo;
+      fifo = w;
+      w = next;
+    }
+
+    // read next first: a waiter lives in its coroutine's frame...
+    while (fifo != nullptr)
+    {
+      auto* const next = fifo->next;
+      fifo->schedule(*fifo);
+      fifo = next;
+    }
+  }
+
+  // async_resume_guard is declared BEFORE the lock in every operation that
+  // can make async_pop() waiters ready so its destructor runs after the
+  // lock's (i.e., after mutex_ is released)...
+  struct async_resume_guard
+  {
+    concurrent_queue& q;
+
+    ~async_resume_guard()
+    {
+      q.resume_ready_async_waiters();
+    }
+  };
+
+  // capacity_ belongs to this object: copy/move construction copies it but
+  // assignment and swap() leave it unchanged. closed_ is guarded by mutex_.
+  size_type capacity_{unbounded};
+  bool closed_{};
+
+  // a copy of inherited_queue::size() (written with mutex_ held) on its
+  // own cache line so threads polling size() and empty() neither take
+  // mutex_ nor keep stealing its cache line...
+  alignas(cache_line_size) std::atomic<size_type> size_{};
+
+  // must be called with mutex_ held after n elements have been added...
+  void notify_not_empty(size_type n = 1)
+  {
+    if (async_head_ != nullptr)
+      serve_async_waiters();
+    if (waiting_consumers_ == 0 || n == 0)
+      return;
+    if (n == 1)
+      not_empty_.notify_one();
+    else
+      not_empty_.notify_all();
+  }
+
+  // must be called with mutex_ held after n elements have been removed...
+  void notify_not_full(size_type n = 1)
+  {
+    if (waiting_producers_ == 0 || n == 0)
+      return;
+    if (n == 1)
+      not_full_.notify_one();
+    else
+      not_full_.notify_all();
+  }
+
+  // must be called with mutex_ held after the contents were replaced...
+  void notify_all_waiters()
+  {
+    notify_not_empty(unbounded);
+    notify_not_full(unbounded);
+  }
+
+  // must be called with mutex_ held whenever the number of elements
+  // changes so size() and empty() can read it without the lock...
+  void publish_size() noexcept
+  {
+    size_.store(inherited_queue::size(), std::memory_order_relaxed);
+  }
+
+  // on_pushed(), on_popped() and on_replaced() must be called with mutex_
+  // held after the queue changed: they record statistics and then wake
+  // whoever can now make progress...
+  void on_pushed(size_type n = 1)
+  {
+    publish_size();
+    if constexpr (Stats::enabled)
+      stats_.on_push(n, inherited_queue::size());
+    notify_not_empty(n);
+  }
+
+  void on_popped(size_type n = 1)
+  {
+    publish_size();
+    if constexpr (Stats::enabled)
+      stats_.on_pop(n);
+    notify_not_full(n);
+  }
+
+  void on_replaced()
+  {
+    reset_tracking();
+    notify_all_waiters();
+  }
+
+  // constructors only need to publish the size of (and start the
+  // statistics for) their contents...
+  void reset_tracking()
+  {
+    publish_size();
+    if constexpr (Stats::enabled)
+      stats_.on_reset(inherited_queue::size());
+  }
+
+  void record_rejected_push()
+  {
+    if constexpr (Stats::enabled)
+      stats_.on_rejected_push();
+  }
+
+  void record_empty_pop()
+  {
+    if constexpr (Stats::enabled)
+      stats_.on_empty_pop();
+  }
+
+  bool has_room_locked(size_type n = 1) const noexcept
+  {
+    auto const sz = inherited_queue::size();
+    return sz < capacity_ && capacity_ - sz >= n;
+  }
+
+  // must be called with mutex_ held and the queue not empty...
+  std::optional<value_type> pop_front_locked()
+  {
+    std::optional<value_type> retval{std::move(inherited_queue::front())};
+    inherited_queue::pop();
+    on_popped();
+    return retval;
+  }
+
+  // containers that keep emptied blocks for reuse (e.g., pooled_deque) must
+  // never be swapped out: their blocks (and free list) would leave with the
+  // elements and the next pushes would allocate again with mutex_ held...
+  static constexpr bool recycles_blocks =
+    requires (container_type const& c) { c.free_blocks(); };
+
+  // returns an empty container with the same allocator as ours (if it has
+  // one) so swapping with it is valid even when allocators do not propagate
+  // (e.g., std::pmr::polymorphic_allocator)...
+  container_type make_empty_container() const
+  {
+    if constexpr (requires { inherited_queue::c.get_allocator(); })
+      return container_type(inherited_queue::c.get_allocator());
+    else
+      return container_type();
+  }
+
+  // must be called with mutex_ held: moves up to max_n elements to out...
+  template <typename OutputIt>
+  OutputIt pop_range_locked(OutputIt out, size_type max_n)
+  {
+    auto const n = std::min(max_n, inherited_queue::size());
+    for (size_type i{}; i != n; ++i)
+    {
+      *out = std::move(inherited_queue::front());
+      ++out;
+      inherited_queue::pop();
+    }
+    on_popped(n);
+    return out;
+  }
+
+  // must be called with mutex_ held: when everything is wanted the whole
+  // container is swapped out instead of moving the elements one by one
+  // (unless it recycles its blocks). NOTE: the returned container's storage
+  // is allocated with mutex_ held, i.e., with pooled_deque only a pool
+  // allocator (or the output iterator overload into a reused buffer) makes
+  // this allocation-free...
+  container_type pop_range_locked(size_type max_n)
+  {
+    auto retval{make_empty_container()};
+    if (!recycles_blocks && max_n >= inherited_queue::size())
+    {
+      using std::swap;
+      swap(retval, inherited_queue::c);
+      on_popped(retval.size());
+    }
+    else
+      pop_range_locked(std::back_inserter(retval), max_n);
+    return retval;
+  }
+
+  // gave_up is the status returned when wait() returns false...
+  template <typename Wait>
+  pop_result wait_pop_impl(Wait&& wait, queue_status gave_up)
+  {
+    std::unique_lock lk{mutex_};
+    if (inherited_queue::empty() && !closed_)
+    {
+      if constexpr (Stats::enabled)
+        stats_.on_consumer_wait();
+      ++waiting_consumers_;
+      bool const ready = std::forward<Wait>(wait)(lk);
+      --waiting_consumers_;
+      if (!ready)
+        return std::unexpected{gave_up};
+    }
+    if (inherited_queue::empty())
+      return std::unexpected{queue_status::closed};
+    return std::move(*pop_front_locked());
+  }
+
+  static std::optional<value_type> to_optional(pop_result&& r)
+  {
+    if (r)
+      return std::move(*r);
+    return std::nullopt;
+  }
+
+  // returns true once there is room to push with lk held or false if the
+  // queue is (or becomes) closed or wait() gives up...
+  template <typename Wait>
+  bool wait_push_impl(std::unique_lock<mutex_type>& lk, Wait&& wait)
+  {
+    if (closed_)
+      return false;
+    if (has_room_locked())
+      return true;
+
+    if constexpr (Stats::enabled)
+      stats_.on_producer_wait();
+    ++waiting_producers_;
+    bool const ready = std::forward<Wait>(wait)(lk);
+    --waiting_producers_;
+    return ready && !closed_;
+  }
+
+  void wait_for_room(std::unique_lock<mutex_type>& lk)
+  {
+    bool const ok = wait_push_impl(lk, [this](std::unique_lock<mutex_type>& l) {
+      not_full_.wait(l, [this] { return closed_ || has_room_locked(); });
+      return true;
+    });
+    if (!ok)
+      throw closed_queue_error{};
+  }
+
+  template <typename V, typename Clock, typename Duration>
+  bool push_until_impl(
+    V&& v,
+    std::chrono::time_point<Clock, Duration> const& abs_time
+  )
+  {
+    async_resume_guard const resume{*this};
+    std::unique_lock lk{mutex_};
+    bool const ok = wait_push_impl(lk, [&](std::unique_lock<mutex_type>& l) {
+      return not_full_.wait_until(
+        l, abs_time, [this] { return closed_ || has_room_locked(); }
+      );
+    });
+    if (!ok)
+      return false;
+    inherited_queue::push(std::forward<V>(v));
+    on_pushed();
+    return true;
+  }
+
+  // must be called with lk holding mutex_: pushes the elements of r while
+  // waiting for room as needed...
+  template <typename R>
+  void push_range_locked(std::unique_lock<mutex_type>& lk, R&& r)
+  {
+    if (capacity_ == unbounded)
+    {
+      if (closed_)
+        throw closed_queue_error{};
+      auto const old_size = inherited_queue::size();
+      inherited_queue::push_range(std::forward<R>(r));
+      on_pushed(inherited_queue::size() - old_size);
+      return;
+    }
+
+    // a bounded queue accepts the range in pieces as consumers make room...
+    for (auto&& x : r)
+    {
+      wait_for_room(lk);
+      inherited_queue::push(std::forward<decltype(x)>(x));
+      on_pushed();
+    }
+  }
+
+  template <typename F, typename Elem>
+  auto peek_impl(F& f, Elem elem) const
+  {
+    using result_type = std::invoke_result_t<F&, value_type const&>;
+
+    std::lock_guard lk{mutex_};
+    if constexpr (std::is_void_v<result_type>)
+    {
+      if (inherited_queue::empty())
+        return false;
+      std::invoke(f, elem());
+      return true;
+    }
+    else
+    {
+      using optional_type = std::optional<std::remove_cvref_t<result_type>>;
+      if (inherited_queue::empty())
+        return optional_type{};
+      return optional_type{std::invoke(f, elem())};
+    }
+  }
 
   queue_type& underlying_queue() noexcept
   {
@@ -58,21 +501,33 @@ protected:
 public:
   concurrent_queue() = default;
 
+  concurrent_queue(bounded_t, size_type capacity) :
+    capacity_{capacity}
+  {
+    if (capacity == 0)
+      throw std::invalid_argument("concurrent_queue capacity must be non-zero");
+  }
+
   explicit concurrent_queue(queue_type const& q) :
     inherited_queue{q}
   {
+    reset_tracking();
   }
 
   concurrent_queue(concurrent_queue const& other)
   {
     std::lock_guard lk{other.mutex_};
     inherited_queue::operator=(static_cast<queue_type const&>(other));
+    capacity_ = other.capacity_;
+    reset_tracking();
   }
 
   concurrent_queue& operator=(queue_type const& q)
   {
+    async_resume_guard const resume{*this};
     std::lock_guard lk{mutex_};
     inherited_queue::operator=(q);
+    on_replaced();
     return *this;
   }
 
@@ -80,8 +535,10 @@ public:
   {
     if (this != std::addressof(other))
     {
+      async_resume_guard const resume{*this};
       std::scoped_lock lk{mutex_, other.mutex_};
       inherited_queue::operator=(static_cast<queue_type const&>(other));
+      on_replaced();
     }
     return *this;
   }
@@ -89,18 +546,24 @@ public:
   explicit concurrent_queue(queue_type&& q) :
     inherited_queue{std::move(q)}
   {
+    reset_tracking();
   }
 
   concurrent_queue(concurrent_queue&& other)
   {
     std::lock_guard lk{other.mutex_};
     inherited_queue::operator=(std::move(other.underlying_queue()));
+    capacity_ = other.capacity_;
+    reset_tracking();
+    other.on_replaced();
   }
 
   concurrent_queue& operator=(queue_type&& q)
   {
+    async_resume_guard const resume{*this};
     std::lock_guard lk{mutex_};
     inherited_queue::operator=(std::move(q));
+    on_replaced();
     return *this;
   }
 
@@ -108,8 +571,11 @@ public:
   {
     if (this != std::addressof(other))
     {
+      async_resume_guard const resume{*this};
       std::scoped_lock lk{mutex_, other.mutex_};
       inherited_queue::operator=(std::move(other.underlying_queue()));
+      on_replaced();
+      other.on_replaced();
     }
     return *this;
   }
@@ -117,11 +583,13 @@ public:
   explicit concurrent_queue(container_type const& c) :
     inherited_queue{c}
   {
+    reset_tracking();
   }
 
   explicit concurrent_queue(container_type&& c) :
     inherited_queue{std::move(c)}
   {
+    reset_tracking();
   }
 
   template <typename InputIt>
@@ -129,6 +597,7 @@ public:
   concurrent_queue(InputIt first, InputIt last) :
     inherited_queue{first, last}
   {
+    reset_tracking();
   }
 
   template <typename R>
@@ -136,13 +605,141 @@ public:
   concurrent_queue(std::from_range_t, R&& r) :
     inherited_queue{std::from_range, std::forward<R>(r)}
   {
+    reset_tracking();
   }
 
-  void clear()
+  // allocator-extended constructors (e.g., to give a pooled_deque or a
+  // std::pmr container its memory resource)...
+  template <typename Alloc>
+  requires std::uses_allocator_v<container_type, Alloc>
+  explicit concurrent_queue(Alloc const& a) :
+    inherited_queue(a)
+  {
+  }
+
+  template <typename Alloc>
+  requires std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(bounded_t, size_type capacity, Alloc const& a) :
+    inherited_queue(a),
+    capacity_{capacity}
+  {
+    if (capacity == 0)
+      throw std::invalid_argument("concurrent_queue capacity must be non-zero");
+  }
+
+  template <typename Alloc>
+  requires std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(container_type const& c, Alloc const& a) :
+    inherited_queue(c, a)
+  {
+    reset_tracking();
+  }
+
+  template <typename Alloc>
+  requires std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(container_type&& c, Alloc const& a) :
+    inherited_queue(std::move(c), a)
+  {
+    reset_tracking();
+  }
+
+  template <typename Alloc>
+  requires std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(concurrent_queue const& other, Alloc const& a) :
+    inherited_queue(a)
+  {
+    std::lock_guard lk{other.mutex_};
+    inherited_queue::operator=(static_cast<queue_type const&>(other));
+    capacity_ = other.capacity_;
+    reset_tracking();
+  }
+
+  template <typename Alloc>
+  requires std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(concurrent_queue&& other, Alloc const& a) :
+    inherited_queue(a)
+  {
+    std::lock_guard lk{other.mutex_};
+    inherited_queue::operator=(std::move(other.underlying_queue()));
+    capacity_ = other.capacity_;
+    reset_tracking();
+    other.on_replaced();
+  }
+
+  template <typename InputIt, typename Alloc>
+  requires compatible_input_iterator_c<InputIt, value_type> &&
+    std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(InputIt first, InputIt last, Alloc const& a) :
+    inherited_queue(first, last, a)
+  {
+    reset_tracking();
+  }
+
+  template <typename R, typename Alloc>
+  requires compatible_input_range_c<R, value_type> &&
+    std::uses_allocator_v<container_type, Alloc>
+  concurrent_queue(std::from_range_t, R&& r, Alloc const& a) :
+    inherited_queue(std::from_range, std::forward<R>(r), a)
   {
-    queue_type tmp;
+    reset_tracking();
+  }
+
+  size_type capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  // stats() is only available when a statistics policy is enabled (see
+  // cq_stats.hpp)...
+  queue_stats_snapshot stats() const
+  requires Stats::enabled
+  {
+    return stats_.snapshot(mutex_);
+  }
+
+  // close() makes all further pushes fail and wakes every blocked producer
+  // and consumer. Elements already queued can still be popped.
+  void close()
+  {
+    async_resume_guard const resume{*this};
     std::lock_guard lk{mutex_};
-    tmp.swap(underlying_queue());
+    closed_ = true;
+    serve_async_waiters();
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  bool is_closed() const
+  {
+    std::lock_guard lk{mutex_};
+    return closed_;
+  }
+
+  // is_drained() is true once the queue is closed and empty, i.e., no
+  // pop will ever return an element again...
+  bool is_drained() const
+  {
+    std::lock_guard lk{mutex_};
+    return closed_ && inherited_queue::empty();
+  }
+
+  void clear()
+  {
+    std::unique_lock lk{mutex_};
+    if constexpr (recycles_blocks)
+    {
+      // destroys the elements in place so the blocks are kept for reuse...
+      inherited_queue::c.clear();
+      on_replaced();
+    }
+    else
+    {
+      // the elements are destroyed after the lock is released...
+      queue_type tmp{make_empty_container()};
+      tmp.swap(underlying_queue());
+      on_replaced();
+      lk.unlock();
+    }
   }
 
   std::optional<value_type> front() const
@@ -161,81 +758,208 @@ public:
     return std::nullopt;
   }
 
-  bool empty() const
+  // peek() and peek_back() call f with a const reference to the front (or
+  // back) element while holding the lock, i.e., without copying it. They
+  // return whether there was an element if f returns void, otherwise
+  // f's result (or std::nullopt if the queue was empty). f must not call
+  // back into this queue.
+  template <typename F>
+  requires std::invocable<F&, value_type const&>
+  auto peek(F&& f) const
   {
-    std::lock_guard lk{mutex_};
-    return inherited_queue::empty();
+    return peek_impl(f, [this]() -> value_type const& {
+      return inherited_queue::front();
+    });
   }
 
-  size_type size() const
+  template <typename F>
+  requires std::invocable<F&, value_type const&>
+  auto peek_back(F&& f) const
   {
-    std::lock_guard lk{mutex_};
-    return inherited_queue::size();
+    return peek_impl(f, [this]() -> value_type const& {
+      return inherited_queue::back();
+    });
   }
 
+  // empty() and size() are wait-free (they do not take the lock) and so
+  // are only a snapshot when other threads are pushing or popping...
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  size_type size() const noexcept
+  {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  // push() and emplace() block while a bounded queue is full and throw
+  // closed_queue_error once the queue is closed...
   void push(value_type const& v)
   {
-    std::lock_guard lk{mutex_};
+    async_resume_guard const resume{*this};
+    std::unique_lock lk{mutex_};
+    wait_for_room(lk);
     inherited_queue::push(v);
+    on_pushed();
   }
 
   void push(value_type&& v)
   {
-    std::lock_guard lk{mutex_};
+    async_resume_guard const resume{*this};
+    std::unique_lock lk{mutex_};
+    wait_for_room(lk);
     inherited_queue::push(std::move(v));
+    on_pushed();
   }
 
+  // the try_*() operations never block: they fail if the lock is busy, the
+  // queue is full or the queue is closed...
   bool try_push(value_type const& v)
   {
+    async_resume_guard const resume{*this};
     std::unique_lock lk{mutex_, std::try_to_lock};
     if (!lk)
       return false;
+    if (closed_ || !has_room_locked())
+    {
+      record_rejected_push();
+      return false;
+    }
     inherited_queue::push(v);
+    on_pushed();
     return true;
   }
 
   bool try_push(value_type&& v)
   {
+    async_resume_guard const resume{*this};
     std::unique_lock lk{mutex_, std::try_to_lock};
     if (!lk)
       return false;
+    if (closed_ || !has_room_locked())
+    {
+      record_rejected_push();
+      return false;
+    }
     inherited_queue::push(std::move(v));
+    on_pushed();
     return true;
   }
 
+  // push_for() and push_until() return false on timeout or if closed...
+  template <typename Rep, typename Period>
+  bool push_for(
+    value_type const& v,
+    std::chrono::duration<Rep, Period> const& rel_time
+  )
+  {
+    return push_until_impl(v, std::chrono::steady_clock::now() + rel_time);
+  }
+
+  template <typename Rep, typename Period>
+  bool push_for(
+    value_type&& v,
+    std::chrono::duration<Rep, Period> const& rel_time
+  )
+  {
+    return push_until_impl(
+      std::move(v), std::chrono::steady_clock::now() + rel_time
+    );
+  }
+
+  template <typename Clock, typename Duration>
+  bool push_until(
+    value_type const& v,
+    std::chrono::time_point<Clock, Duration> const& abs_time
+  )
+  {
+    return push_until_impl(v, abs_time);
+  }
+
+  template <typename Clock, typename Duration>
+  bool push_until(
+    value_type&& v,
+    std::chrono::time_point<Clock, Duration> const& abs_time
+  )
+  {
+    return push_until_impl(std::move(v), abs_time);
+  }
+
+  // on a bounded queue push_range() may release the lock between elements
+  // while it waits for room, i.e., the range is not inserted atomically...
   template <typename R>
   requires compatible_input_range_c<R, value_type>
   void push_range(R&& r)
   {
-    std::lock_guard lk{mutex_};
-    inherited_queue::push_range(std::forward<R>(r));
+    async_resume_guard const resume{*this};
+    std::unique_lock lk{mutex_};
+    push_range_locked(lk, std::forward<R>(r));
   }
 
+  // try_push_range() is all-or-nothing: it fails unless the entire range
+  // fits. (Single-pass ranges headed for a bounded queue are first
+  // materialized, so their elements are consumed even on failure.)
   template <typename R>
   requires compatible_input_range_c<R, value_type>
   bool try_push_range(R&& r)
   {
+    if constexpr (!std::ranges::forward_range<R>)
+    {
+      if (capacity_ != unbounded)
+      {
+        std::vector<value_type> tmp;
+        for (auto&& x : r)
+          tmp.emplace_back(std::forward<decltype(x)>(x));
+        return try_push_range(std::move(tmp));
+      }
+    }
+
+    async_resume_guard const resume{*this};
     std::unique_lock lk{mutex_, std::try_to_lock};
     if (!lk)
       return false;
+
+    bool fits = !closed_;
+    if constexpr (std::ranges::forward_range<R>)
+      fits = fits &&
+        has_room_locked(static_cast<size_type>(std::ranges::distance(r)));
+    if (!fits)
+    {
+      record_rejected_push();
+      return false;
+    }
+
+    auto const old_size = inherited_queue::size();
     inherited_queue::push_range(std::forward<R>(r));
+    on_pushed(inherited_queue::size() - old_size);
     return true;
   }
 
   template <typename... Args>
   void emplace(Args&&... args)
   {
-    std::lock_guard lk{mutex_};
+    async_resume_guard const resume{*this};
+    std::unique_lock lk{mutex_};
+    wait_for_room(lk);
     inherited_queue::emplace(std::forward<Args>(args)...);
+    on_pushed();
   }
 
   template <typename... Args>
   bool try_emplace(Args&&... args)
   {
+    async_resume_guard const resume{*this};
     std::unique_lock lk{mutex_, std::try_to_lock};
     if (!lk)
       return false;
+    if (closed_ || !has_room_locked())
+    {
+      record_rejected_push();
+      return false;
+    }
     inherited_queue::emplace(std::forward<Args>(args)...);
+    on_pushed();
     return true;
   }
 
@@ -243,11 +967,323 @@ public:
   {
     std::lock_guard lk{mutex_};
     if (inherited_queue::empty())
+    {
+      record_empty_pop();
       return std::nullopt;
+    }
+    return pop_front_locked();
+  }
 
-    std::optional<value_type> retval{std::move(inherited_queue::front())};
-    inherited_queue::pop();
-    return retval;
+  // pop_range() moves up to max_n elements (in FIFO order) out of the queue
+  // while holding the lock once. The output iterator overloads return the
+  // iterator one past the last element written...
+  template <typename OutputIt>
+  requires std::output_iterator<OutputIt, value_type&&>
+  OutputIt pop_range(OutputIt out, size_type max_n)
+  {
+    std::lock_guard lk{mutex_};
+    return pop_range_locked(std::move(out), max_n);
+  }
+
+  container_type pop_range(size_type max_n = unbounded)
+  {
+    std::lock_guard lk{mutex_};
+    return pop_range_locked(max_n);
+  }
+
+  // try_pop_range() returns false (and pops nothing) if the lock is busy...
+  template <typename OutputIt>
+  requires std::output_iterator<OutputIt, value_type&&>
+  auto try_pop_range(OutputIt out, size_type max_n)
+    -> std::tuple<bool, OutputIt>
+  {
+    std::unique_lock lk{mutex_, std::try_to_lock};
+    if (!lk)
+      return {false, std::move(out)};
+    return {true, pop_range_locked(std::move(out), max_n)};
+  }
+
+  auto try_pop_range(size_type max_n = unbounded)
+    -> std::tuple<bool, container_type>
+  {
+    std::unique_lock lk{mutex_, std::try_to_lock};
+    if (!lk)
+      return {false, container_type{}};
+    return {true, pop_range_locked(max_n)};
+  }
+
+  // wait_pop() blocks until an element is available and then pops it. It
+  // returns std::nullopt only if the queue is closed and drained.
+  std::optional<value_type> wait_pop()
+  {
+    return to_optional(wait_pop_expected());
+  }
+
+  // wait_pop(stoken) also returns std::nullopt if stop is requested first...
+  std::optional<value_type> wait_pop(std::stop_token stoken)
+  {
+    return to_optional(wait_pop_expected(std::move(stoken)));
+  }
+
+  // wait_pop_for() and wait_pop_until() also return std::nullopt on timeout...
+  template <typename Rep, typename Period>
+  std::optional<value_type> wait_pop_for(
+    std::chrono::duration<Rep, Period> const& rel_time
+  )
+  {
+    return to_optional(wait_pop_expected_for(rel_time));
+  }
+
+  template <typename Clock, typename Duration>
+  std::optional<value_type> wait_pop_until(
+    std::chrono::time_point<Clock, Duration> const& abs_time
+  )
+  {
+    return to_optional(wait_pop_expected_until(abs_time));
+  }
+
+  // the *_expected() pops say why they did not return an element (see
+  // queue_status), e.g., queue_status::closed is the end of the stream
+  // while queue_status::empty only means nothing is queued right now...
+  pop_result pop_expected()
+  {
+    std::lock_guard lk{mutex_};
+    if (!inherited_queue::empty())
+      return std::move(*pop_front_locked());
+    if (closed_)
+      return std::unexpected{queue_status::closed};
+    record_empty_pop();
+    return std::unexpected{queue_status::empty};
+  }
+
+  pop_result try_pop_expected()
+  {
+    std::unique_lock lk{mutex_, std::try_to_lock};
+    if (!lk)
+      return std::unexpected{queue_status::busy};
+    if (!inherited_queue::empty())
+      return std::move(*pop_front_locked());
+    if (closed_)
+      return std::unexpected{queue_status::closed};
+    record_empty_pop();
+    return std::unexpected{queue_status::empty};
+  }
+
+  pop_result wait_pop_expected()
+  {
+    return wait_pop_impl([this](std::unique_lock<mutex_type>& lk) {
+      not_empty_.wait(
+        lk, [this] { return closed_ || !inherited_queue::empty(); }
+      );
+      return true;
+    }, queue_status::closed);
+  }
+
+  pop_result wait_pop_expected(std::stop_token stoken)
+  {
+    return wait_pop_impl([&](std::unique_lock<mutex_type>& lk) {
+      return not_empty_.wait(
+        lk, stoken, [this] { return closed_ || !inherited_queue::empty(); }
+      );
+    }, queue_status::stopped);
+  }
+
+  template <typename Rep, typename Period>
+  pop_result wait_pop_expected_for(
+    std::chrono::duration<Rep, Period> const& rel_time
+  )
+  {
+    return wait_pop_impl([&](std::unique_lock<mutex_type>& lk) {
+      return not_empty_.wait_for(
+        lk, rel_time, [this] { return closed_ || !inherited_queue::empty(); }
+      );
+    }, queue_status::timeout);
+  }
+
+  template <typename Clock, typename Duration>
+  pop_result wait_pop_expected_until(
+    std::chrono::time_point<Clock, Duration> const& abs_time
+  )
+  {
+    return wait_pop_impl([&](std::unique_lock<mutex_type>& lk) {
+      return not_empty_.wait_until(
+        lk, abs_time, [this] { return closed_ || !inherited_queue::empty(); }
+      );
+    }, queue_status::timeout);
+  }
+
+  // consume() is the range of elements popped by wait_pop(stoken): it
+  // blocks while the queue is empty and ends once the queue is closed and
+  // drained (or stop is requested), e.g.,
+  //
+  //   for (auto&& v : q.consume())
+  //     process(v);
+  //
+  // NOTE: The queue must outlive the generator.
+  std::generator<value_type> consume(std::stop_token stoken = {})
+  {
+    while (auto v = wait_pop(stoken))
+      co_yield std::move(*v);
+  }
+
+  // async_pop_awaiter is returned by async_pop(): co_await-ing it yields
+  // the next element (or std::nullopt once the queue is closed and
+  // drained), suspending the coroutine while the queue is empty. The
+  // suspended coroutine is resumed by passing its handle to the executor
+  // once a producer has handed it an element.
+  //
+  // NOTE: The queue must outlive every coroutine suspended on it.
+  template <async_executor_c Executor>
+  class async_pop_awaiter : async_waiter
+  {
+    concurrent_queue& q_;
+    [[no_unique_address]] Executor ex_;
+
+    static void schedule_on_executor(async_waiter& w)
+    {
+      auto& self = static_cast<async_pop_awaiter&>(w);
+      self.ex_(self.handle);
+    }
+
+  public:
+    async_pop_awaiter(concurrent_queue& q, Executor ex) :
+      q_{q},
+      ex_{std::move(ex)}
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    // returns false (i.e., do not suspend) if an element or end-of-stream
+    // is available right away...
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+      std::lock_guard lk{q_.mutex_};
+      if (!q_.inherited_queue::empty())
+      {
+        this->value = q_.pop_front_locked();
+        return false;
+      }
+      if (q_.closed_)
+        return false;
+
+      this->handle = h;
+      this->schedule = &schedule_on_executor;
+      this->next = nullptr;
+      if (q_.async_tail_ != nullptr)
+        q_.async_tail_->next = this;
+      else
+        q_.async_head_ = this;
+      q_.async_tail_ = this;
+      return true;
+    }
+
+    std::optional<value_type> await_resume()
+    {
+      return std::move(this->value);
+    }
+  };
+
+  template <async_executor_c Executor = inline_executor>
+  async_pop_awaiter<Executor> async_pop(Executor ex = {})
+  {
+    return {*this, std::move(ex)};
+  }
+
+  // async_range adapts the queue for coroutine-style draining that ends
+  // once the queue is closed and drained, i.e.,
+  //
+  //   auto r = q.as_async_range();
+  //   for (auto it = co_await r.begin(); it != r.end(); co_await ++it)
+  //     use(*it);
+  template <async_executor_c Executor>
+  class async_range
+  {
+    concurrent_queue& q_;
+    [[no_unique_address]] Executor ex_;
+    std::optional<value_type> current_;
+
+  public:
+    class iterator;
+
+    // advance_awaiter stores the popped element in the range and produces
+    // an iterator to it...
+    class advance_awaiter : public async_pop_awaiter<Executor>
+    {
+      async_range& r_;
+
+    public:
+      explicit advance_awaiter(async_range& r) :
+        async_pop_awaiter<Executor>{r.q_, r.ex_},
+        r_{r}
+      {
+      }
+
+      iterator await_resume()
+      {
+        r_.current_ = async_pop_awaiter<Executor>::await_resume();
+        return iterator{r_};
+      }
+    };
+
+    class iterator
+    {
+      async_range* r_;
+
+    public:
+      using value_type = concurrent_queue::value_type;
+      using difference_type = std::ptrdiff_t;
+
+      explicit iterator(async_range& r) noexcept :
+        r_{std::addressof(r)}
+      {
+      }
+
+      value_type& operator*() const noexcept
+      {
+        return *r_->current_;
+      }
+
+      value_type* operator->() const noexcept
+      {
+        return std::addressof(*r_->current_);
+      }
+
+      advance_awaiter operator++()
+      {
+        return advance_awaiter{*r_};
+      }
+
+      bool operator==(std::default_sentinel_t) const noexcept
+      {
+        return !r_->current_.has_value();
+      }
+    };
+
+    async_range(concurrent_queue& q, Executor ex) :
+      q_{q},
+      ex_{std::move(ex)}
+    {
+    }
+
+    advance_awaiter begin()
+    {
+      return advance_awaiter{*this};
+    }
+
+    std::default_sentinel_t end() const noexcept
+    {
+      return std::default_sentinel;
+    }
+  };
+
+  template <async_executor_c Executor = inline_executor>
+  async_range<Executor> as_async_range(Executor ex = {})
+  {
+    return {*this, std::move(ex)};
   }
 
   auto try_pop() -> std::tuple<bool, std::optional<value_type>>
@@ -257,12 +1293,16 @@ public:
       return {false, std::nullopt};
 
     if (inherited_queue::empty())
+    {
+      record_empty_pop();
       return {true, std::nullopt};
+    }
 
     std::tuple<bool, std::optional<value_type>> retval{
       true, std::move(inherited_queue::front())
     };
     inherited_queue::pop();
+    on_popped();
     return retval;
   }
 
@@ -285,15 +1325,19 @@ public:
     if (this == std::addressof(other))
       return;
 
+    async_resume_guard const resume{*this};
+    async_resume_guard const other_resume{other};
     std::scoped_lock lk{mutex_, other.mutex_};
     underlying_queue().swap(other.underlying_queue());
+    on_replaced();
+    other.on_replaced();
   }
 };
 
-template <typename T, typename Container>
+template <typename T, typename Container, typename Stats>
 inline void swap(
-  concurrent_queue<T, Container>& a,
-  concurrent_queue<T, Container>& b
+  concurrent_queue<T, Container, Stats>& a,
+  concurrent_queue<T, Container, Stats>& b
 )
 {
   a.swap(b);
@@ -303,52 +1347,160 @@ inline void swap(
 
 namespace std {
 
-template <typename T, typename Container, typename Alloc>
-struct uses_allocator<comp3400_2026w::concurrent_queue<T, Container>, Alloc> :
+template <typename T, typename Container, typename Stats, typename Alloc>
+struct uses_allocator<
+  comp3400_2026w::concurrent_queue<T, Container, Stats>, Alloc
+> :
   uses_allocator<Container, Alloc>::type
 {
 };
 
-template <typename Ch, typename T, typename Container>
+// The format spec selects how much is formatted and how long the lock is
+// held:
+//
+//   {}     every element, formatted while holding the lock
+//   {:s}   snapshot: every element is copied while holding the lock and
+//          then formatted after releasing it
+//   {:hN}  the first N elements (copied, then formatted after releasing
+//          the lock) followed by "... (+M more)" if there are others
+//   {:tN}  likewise for the last N elements, preceded by "(+M more) ..."
+//   {:n}   only the element count, e.g., "<42 elements>" (lock-free)
+//
+// (s, h and t require copyable elements.)
+template <typename Ch, typename T, typename Container, typename Stats>
 requires std::formattable<T, Ch>
-struct formatter<comp3400_2026w::concurrent_queue<T, Container>, Ch>
+struct formatter<comp3400_2026w::concurrent_queue<T, Container, Stats>, Ch>
 {
+private:
+  using cq_type = comp3400_2026w::concurrent_queue<T, Container, Stats>;
+
+  enum class mode { locked, snapshot, head, tail, count };
+  mode mode_{mode::locked};
+  std::size_t n_{};
+
+  template <typename OutputIt, typename R>
+  static OutputIt format_elements(OutputIt out, R const& r)
+  {
+    bool first = true;
+    for (auto const& x : r)
+    {
+      if (!first)
+        out = std::format_to(out, " ");
+      out = std::format_to(out, "{}", x);
+      first = false;
+    }
+    return out;
+  }
+
+  // copies the wanted elements while holding the lock and returns them
+  // with the number of elements that were left out. NOTE: {:tN} steps back
+  // N elements from the end of a bidirectional container (e.g., std::deque,
+  // std::list) but has to walk over the whole queue when the container is
+  // only forward iterable (e.g., pooled_deque), i.e., it is O(size) with
+  // the lock held there...
+  auto copy_out(cq_type const& cq) const
+    -> std::tuple<std::vector<T>, std::size_t>
+  {
+    std::lock_guard lk{cq.mutex_};
+    auto const& cont = cq.cq_type::inherited_queue::c;
+    auto const total = static_cast<std::size_t>(std::ranges::size(cont));
+    auto const k = mode_ == mode::snapshot ? total : std::min(n_, total);
+
+    auto first = std::ranges::begin(cont);
+    if (mode_ == mode::tail)
+    {
+      using cont_type = std::remove_cvref_t<decltype(cont)>;
+      if constexpr (
+        std::ranges::bidirectional_range<cont_type> &&
+        std::ranges::common_range<cont_type>
+      )
+        first = std::ranges::prev(
+          std::ranges::end(cont), static_cast<std::ptrdiff_t>(k)
+        );
+      else
+        std::ranges::advance(first, static_cast<std::ptrdiff_t>(total - k));
+    }
+
+    std::vector<T> elems;
+    elems.reserve(k);
+    for (std::size_t i{}; i != k; ++i, ++first)
+      elems.push_back(*first);
+    return {std::move(elems), total - k};
+  }
+
+public:
   constexpr auto parse(std::basic_format_parse_context<Ch>& ctx)
   {
     auto it = ctx.begin();
+    if (it == ctx.end() || *it == '}')
+      return it;
+
+    switch (*it)
+    {
+      case 'n': mode_ = mode::count; break;
+      case 's': mode_ = mode::snapshot; break;
+      case 'h': mode_ = mode::head; break;
+      case 't': mode_ = mode::tail; break;
+      default:
+        throw std::format_error(
+          "invalid format specifier for concurrent_queue"
+        );
+    }
+    ++it;
+
+    if (mode_ == mode::head || mode_ == mode::tail)
+    {
+      if (it == ctx.end() || *it < '0' || *it > '9')
+        throw std::format_error("concurrent_queue h and t need a count");
+      for (; it != ctx.end() && *it >= '0' && *it <= '9'; ++it)
+        n_ = n_ * 10 + static_cast<std::size_t>(*it - '0');
+    }
+
+    if (mode_ != mode::count && !std::copy_constructible<T>)
+      throw std::format_error(
+        "concurrent_queue s, h and t need copyable elements"
+      );
+
     if (it != ctx.end() && *it != '}')
       throw std::format_error("invalid format specifier for concurrent_queue");
     return it;
   }
 
   template <typename FormatContext>
-  auto format(
-    comp3400_2026w::concurrent_queue<T, Container> const& cq,
-    FormatContext& ctx
-  ) const
+  auto format(cq_type const& cq, FormatContext& ctx) const
   {
-    std::lock_guard lk{cq.mutex_};
-
     auto out = ctx.out();
-    auto const& cont =
-      cq.comp3400_2026w::concurrent_queue<T, Container>::inherited_queue::c;
 
-    if (cont.empty())
-      return std::format_to(out, "<empty>");
+    if (mode_ == mode::count)
+      return std::format_to(out, "<{} elements>", cq.size());
 
-    bool first = true;
-    for (auto const& x : cont)
+    if (mode_ == mode::locked)
     {
-      if (!first)
-        out = std::format_to(out, " ");
-      out = std::format_to(out, "{}", x);
-      first = false;
+      std::lock_guard lk{cq.mutex_};
+      auto const& cont = cq.cq_type::inherited_queue::c;
+      if (cont.empty())
+        return std::format_to(out, "<empty>");
+      return format_elements(out, cont);
     }
 
+    if constexpr (std::copy_constructible<T>)
+    {
+      auto const [elems, omitted] = copy_out(cq);
+      if (elems.empty() && omitted == 0)
+        return std::format_to(out, "<empty>");
+
+      if (mode_ == mode::tail && omitted != 0)
+        out = std::format_to(out, "(+{} more) ...{}", omitted,
+          elems.empty() ? "" : " ");
+      out = format_elements(out, elems);
+      if (mode_ == mode::head && omitted != 0)
+        out = std::format_to(out, "{}... (+{} more)",
+          elems.empty() ? "" : " ", omitted);
+    }
     return out;
   }
 };
 
 } // namespace std
 
-#endif // include_concurrent_queue_hpp_
\ No newline at end of file
+#endif // include_concurrent_queue_hpp_
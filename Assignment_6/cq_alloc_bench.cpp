@@ -0,0 +1,261 @@
+// cq_alloc_bench: heap allocations and lock hold times of concurrent_queue
+// with std::deque versus pooled_deque (see pooled_deque.hpp).
+//
+// Usage: cq_alloc_bench.exe [OPS]
+//
+// Each run does a warm-up round (so the queue has grown to its working
+// depth) and then a measured round of P producers pushing OPS elements
+// each and P consumers popping them. The global operator new is replaced
+// to count allocations made during the measured round (by any thread).
+// Lock hold times come from queue_stats (see cq_stats.hpp). (A measured
+// round that queues deeper than the warm-up did still allocates blocks.)
+//
+// Outputs CSV (to std::cout) with the columns:
+//   container,payload_bytes,producers,consumers,ops,seconds,ops_per_sec,
+//   steady_allocs,hold_p50_ns,hold_p99_ns,hold_p999_ns
+//
+// Before that, check_steady_state() runs push()/pop(), pop_range() and
+// clear() cycles on the pooled_deque queues (single threaded so the depth is
+// always the same): once warmed up they must not allocate at all, otherwise
+// the failure is reported to stderr and the exit status is 1.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "concurrent_queue.hpp"
+#include "cq_stats.hpp"
+#include "pooled_deque.hpp"
+
+using namespace comp3400_2026w;
+
+//=============================================================================
+
+std::atomic<std::uint64_t> allocation_count;
+
+void* operator new(std::size_t n)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (auto* const p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+//=============================================================================
+
+template <std::size_t N>
+struct payload
+{
+  std::array<std::byte, N> bytes{};
+};
+
+// runs one round, returns its duration in seconds...
+template <typename Q>
+double run_round(Q& q, std::size_t pairs, std::size_t ops)
+{
+  using value_type = typename Q::value_type;
+
+  std::atomic<std::size_t> consumed{};
+  auto const total = pairs * ops;
+  auto const t0 = std::chrono::steady_clock::now();
+  {
+    std::vector<std::jthread> threads;
+    threads.reserve(2 * pairs);
+    for (std::size_t i{}; i != pairs; ++i)
+    {
+      threads.emplace_back([&] {
+        for (std::size_t n{}; n != ops; ++n)
+          q.push(value_type{});
+      });
+      threads.emplace_back([&] {
+        while (consumed.load(std::memory_order_relaxed) < total)
+        {
+          if (q.pop())
+            consumed.fetch_add(1, std::memory_order_relaxed);
+          else
+            std::this_thread::yield();
+        }
+      });
+    }
+  }
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - t0
+  ).count();
+}
+
+// returns false (after reporting to stderr) if push()/pop(), pop_range()
+// and clear() cycles allocate once the queue has been to their depth...
+template <typename T, typename Container, typename... CtorArgs>
+bool check_steady_state(std::string_view name, CtorArgs const&... args)
+{
+  constexpr std::size_t depth = 10'000;
+
+  concurrent_queue<T, Container> q(args...);
+  std::vector<T> out;
+  out.reserve(depth);
+
+  auto fill = [&] {
+    for (std::size_t i{}; i != depth; ++i)
+      q.push(T{});
+  };
+  auto cycle = [&] {
+    fill();
+    while (q.pop())
+      ;
+
+    fill();
+    out.clear();
+    q.pop_range(std::back_inserter(out), depth);
+
+    fill();
+    q.clear();
+
+    // the returned container's blocks only come back without allocating
+    // when they are drawn from a pool...
+    if constexpr (!std::is_same_v<typename Container::allocator_type, std::allocator<T>>)
+    {
+      fill();
+      auto drained = q.pop_range();
+    }
+  };
+
+  cycle();
+  auto const a0 = allocation_count.load();
+  for (int i{}; i != 3; ++i)
+    cycle();
+  auto const allocs = allocation_count.load() - a0;
+
+  if (allocs != 0 || !q.empty())
+  {
+    std::println(stderr,
+      "FAILED: {} (payload {} bytes): {} allocations in steady state.",
+      name, sizeof(T), allocs);
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool check_all()
+{
+  std::pmr::synchronized_pool_resource pool;
+  using alloc = std::pmr::polymorphic_allocator<T>;
+  bool const pooled = check_steady_state<T, pooled_deque<T>>("pooled_deque");
+  bool const pmr =
+    check_steady_state<T, pooled_deque<T, pooled_deque_block_size<T>, alloc>>(
+      "pooled_deque+pmr", alloc{&pool}
+    );
+  return pooled && pmr;
+}
+
+// queue_stats keeps its own std::deque of enqueue times so the allocation
+// count and throughput are measured on a queue without statistics and the
+// lock hold times on a second queue with them...
+template <typename T, typename Container, typename... CtorArgs>
+void run(
+  std::string_view name, std::size_t pairs, std::size_t ops,
+  CtorArgs const&... args
+)
+{
+  double seconds{};
+  std::uint64_t allocs{};
+  {
+    concurrent_queue<T, Container> q(args...);
+    run_round(q, pairs, ops);
+
+    // the threads (and their stacks) are created in every round so their
+    // allocations are subtracted out using an empty round...
+    auto const a0 = allocation_count.load();
+    run_round(q, pairs, 0);
+    auto const thread_allocs = allocation_count.load() - a0;
+
+    auto const a1 = allocation_count.load();
+    seconds = run_round(q, pairs, ops);
+    allocs = allocation_count.load() - a1 - thread_allocs;
+  }
+
+  latency_histogram::snapshot_type hold;
+  {
+    concurrent_queue<T, Container, queue_stats> q(args...);
+    run_round(q, pairs, ops);
+    auto const before = q.stats();
+    run_round(q, pairs, ops);
+    auto const after = q.stats();
+
+    // only count the second round's lock holds...
+    for (std::size_t b{}; b != hold.buckets.size(); ++b)
+      hold.buckets[b] =
+        after.lock_hold.buckets[b] - before.lock_hold.buckets[b];
+  }
+
+  auto const n = 2 * pairs * ops;
+  std::println(
+    "{},{},{},{},{},{:.6f},{:.0f},{},{},{},{}",
+    name, sizeof(T), pairs, pairs, n, seconds, n / seconds, allocs,
+    hold.percentile(0.5).count(),
+    hold.percentile(0.99).count(),
+    hold.percentile(0.999).count()
+  );
+}
+
+template <typename T>
+void run_all(std::size_t pairs, std::size_t ops)
+{
+  run<T, std::deque<T>>("std::deque", pairs, ops);
+  run<T, pooled_deque<T>>("pooled_deque", pairs, ops);
+
+  // the blocks come from a pool resource (which is only touched when a new
+  // block is needed or when shrink_to_fit() is called)...
+  std::pmr::synchronized_pool_resource pool;
+  using alloc = std::pmr::polymorphic_allocator<T>;
+  run<T, pooled_deque<T, pooled_deque_block_size<T>, alloc>>(
+    "pooled_deque+pmr", pairs, ops, alloc{&pool}
+  );
+}
+
+int main(int argc, char* argv[])
+{
+  // (both are run so a failure with one payload doesn't hide the other)
+  bool const steady_int = check_all<int>();
+  bool const steady_payload = check_all<payload<64>>();
+  bool const steady = steady_int && steady_payload;
+
+  std::size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200'000;
+
+  std::vector<std::size_t> pair_counts;
+  auto const hw = std::max(2u, std::thread::hardware_concurrency());
+  for (std::size_t n = 1; n <= hw / 2; n *= 2)
+    pair_counts.push_back(n);
+
+  std::println("container,payload_bytes,producers,consumers,ops,seconds,"
+    "ops_per_sec,steady_allocs,hold_p50_ns,hold_p99_ns,hold_p999_ns");
+  for (auto const pairs : pair_counts)
+  {
+    run_all<int>(pairs, ops);
+    run_all<payload<64>>(pairs, ops);
+  }
+  return steady ? 0 : 1;
+}
@@ -0,0 +1,477 @@
+// cq_bench: throughput/latency benchmark of every queue backend that
+// satisfies basic_concurrent_queue_c.
+//
+// Usage: cq_bench.exe [--quick] [--json] [--ops N]
+//
+//   --quick  a small sweep (e.g., for a smoke test)
+//   --json   output a JSON array instead of CSV
+//   --ops N  elements pushed per producer (pipeline) or operations per
+//            thread (mixed), scaled down for large payloads
+//
+// Scenarios:
+//   pipeline  P producer threads push (batch at a time with push_range()
+//             when batch > 1) and C consumer threads pop (with pop_range()
+//             when the backend has it) until every element is consumed
+//   mixed     T threads each do a random mix of try_push() (with
+//             probability push_ratio) and pop() like a06-soln.cpp does
+//
+// Latency is sampled (every 16th call is timed) so the clock reads do not
+// dominate the throughput figures. Each batch call counts as one call.
+// Columns (CSV) / keys (JSON):
+//   backend,scenario,payload_bytes,threads,producers,consumers,push_ratio,
+//   batch,ops,seconds,ops_per_sec,p50_ns,p99_ns,p999_ns
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <print>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "concurrent_priority_queue.hpp"
+#include "concurrent_queue.hpp"
+#include "cq_concepts.hpp"
+#include "mpmc_queue.hpp"
+#include "pooled_deque.hpp"
+#include "sharded_concurrent_queue.hpp"
+#include "spsc_queue.hpp"
+
+using namespace comp3400_2026w;
+
+//=============================================================================
+
+template <std::size_t N>
+struct payload
+{
+  std::array<std::byte, N> bytes{};
+
+  // (for concurrent_priority_queue)...
+  auto operator<=>(payload const&) const = default;
+};
+
+// each backend is a template so it can be instantiated per payload type...
+template <typename T>
+struct unbounded_backend
+{
+  static constexpr std::string_view name = "concurrent_queue";
+  static constexpr bool single_producer_consumer = false;
+  using queue = concurrent_queue<T>;
+  static auto make() { return std::make_unique<queue>(); }
+};
+
+template <typename T>
+struct bounded_backend
+{
+  static constexpr std::string_view name = "concurrent_queue_bounded";
+  static constexpr bool single_producer_consumer = false;
+  using queue = concurrent_queue<T>;
+  static auto make() { return std::make_unique<queue>(bounded, 1024); }
+};
+
+template <typename T>
+struct pooled_backend
+{
+  static constexpr std::string_view name = "concurrent_queue_pooled";
+  static constexpr bool single_producer_consumer = false;
+  using queue = concurrent_queue<T, pooled_deque<T>>;
+  static auto make() { return std::make_unique<queue>(); }
+};
+
+template <typename T>
+struct priority_backend
+{
+  static constexpr std::string_view name = "concurrent_priority_queue";
+  static constexpr bool single_producer_consumer = false;
+  using queue = concurrent_priority_queue<T>;
+  static auto make() { return std::make_unique<queue>(); }
+};
+
+template <typename T>
+struct spsc_backend
+{
+  static constexpr std::string_view name = "spsc_queue";
+  static constexpr bool single_producer_consumer = true;
+  using queue = spsc_queue<T, 1024>;
+  static auto make() { return std::make_unique<queue>(); }
+};
+
+template <typename T>
+struct mpmc_backend
+{
+  static constexpr std::string_view name = "mpmc_queue";
+  static constexpr bool single_producer_consumer = false;
+  using queue = mpmc_queue<T, 1024>;
+  static auto make() { return std::make_unique<queue>(); }
+};
+
+template <typename T>
+struct sharded_backend
+{
+  static constexpr std::string_view name = "sharded_concurrent_queue";
+  static constexpr bool single_producer_consumer = false;
+  using queue = sharded_concurrent_queue<T>;
+  static auto make() { return std::make_unique<queue>(); }
+};
+
+//=============================================================================
+
+struct config
+{
+  std::string_view scenario;
+  std::size_t producers{};
+  std::size_t consumers{};
+  double push_ratio{};
+  std::size_t batch{1};
+  std::size_t ops{};
+};
+
+struct result
+{
+  std::size_t ops{};
+  double seconds{};
+  std::vector<std::uint32_t> samples_ns;
+};
+
+bool json_output = false;
+bool first_json_row = true;
+
+using bench_clock = std::chrono::steady_clock;
+
+// sampler times every 16th call into a thread-local vector...
+class sampler
+{
+  std::vector<std::uint32_t> samples_;
+  std::uint32_t tick_{};
+
+public:
+  template <typename F>
+  decltype(auto) operator()(F&& f)
+  {
+    if ((tick_++ & 15) != 0)
+      return std::forward<F>(f)();
+
+    auto const t0 = bench_clock::now();
+    struct record_on_exit
+    {
+      sampler& s;
+      bench_clock::time_point t0;
+      ~record_on_exit()
+      {
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          bench_clock::now() - t0
+        ).count();
+        s.samples_.push_back(static_cast<std::uint32_t>(
+          std::min<std::int64_t>(ns, UINT32_MAX)
+        ));
+      }
+    } const rec{*this, t0};
+    return std::forward<F>(f)();
+  }
+
+  std::vector<std::uint32_t>& samples() noexcept
+  {
+    return samples_;
+  }
+};
+
+std::uint64_t percentile(std::vector<std::uint32_t>& v, double p)
+{
+  if (v.empty())
+    return 0;
+  auto const i = std::min(v.size() - 1, static_cast<std::size_t>(p * v.size()));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(i),
+    v.end());
+  return v[i];
+}
+
+template <typename Q>
+concept has_pop_range_c =
+  requires (Q q, typename Q::value_type* out, typename Q::size_type n)
+  {
+    q.pop_range(out, n);
+  };
+
+//=============================================================================
+
+template <typename Q>
+result run_pipeline(Q& q, config const& cfg)
+{
+  using value_type = typename Q::value_type;
+
+  auto const total = cfg.producers * cfg.ops;
+  std::atomic<std::size_t> consumed{};
+  bench_clock::time_point t0;
+  std::barrier start(
+    static_cast<std::ptrdiff_t>(cfg.producers + cfg.consumers + 1),
+    [&t0]() noexcept { t0 = bench_clock::now(); }
+  );
+  std::vector<sampler> samplers(cfg.producers + cfg.consumers);
+
+  result retval;
+  {
+    std::vector<std::jthread> threads;
+    for (std::size_t p{}; p != cfg.producers; ++p)
+      threads.emplace_back([&, p] {
+        auto& sample = samplers[p];
+        std::vector<value_type> batch(cfg.batch);
+        start.arrive_and_wait();
+        for (std::size_t n{}; n < cfg.ops; n += cfg.batch)
+        {
+          if (cfg.batch == 1)
+            sample([&] { q.push(value_type{}); });
+          else
+          {
+            batch.resize(std::min(cfg.batch, cfg.ops - n));
+            sample([&] { q.push_range(batch); });
+          }
+        }
+      });
+
+    for (std::size_t c{}; c != cfg.consumers; ++c)
+      threads.emplace_back([&, c] {
+        auto& sample = samplers[cfg.producers + c];
+        std::vector<value_type> batch(cfg.batch);
+        start.arrive_and_wait();
+        while (consumed.load(std::memory_order_relaxed) < total)
+        {
+          std::size_t got{};
+          if constexpr (has_pop_range_c<Q>)
+          {
+            if (cfg.batch > 1)
+              got = static_cast<std::size_t>(sample([&] {
+                return q.pop_range(batch.data(), cfg.batch) - batch.data();
+              }));
+            else
+              got = sample([&] { return q.pop(); }) ? 1 : 0;
+          }
+          else
+          {
+            for (std::size_t i{}; i != cfg.batch; ++i, ++got)
+              if (!sample([&] { return q.pop(); }))
+                break;
+          }
+
+          if (got == 0)
+            std::this_thread::yield();
+          else
+            consumed.fetch_add(got, std::memory_order_relaxed);
+        }
+      });
+
+    // the clock starts as the barrier releases every thread at once...
+    start.arrive_and_wait();
+    threads.clear();
+    retval.seconds =
+      std::chrono::duration<double>(bench_clock::now() - t0).count();
+  }
+
+  // pushes plus pops...
+  retval.ops = 2 * total;
+  for (auto& s : samplers)
+    retval.samples_ns.insert(retval.samples_ns.end(),
+      s.samples().begin(), s.samples().end());
+  return retval;
+}
+
+template <typename Q>
+result run_mixed(Q& q, config const& cfg)
+{
+  using value_type = typename Q::value_type;
+
+  auto const threads_n = cfg.producers;
+  bench_clock::time_point t0;
+  std::barrier start(
+    static_cast<std::ptrdiff_t>(threads_n + 1),
+    [&t0]() noexcept { t0 = bench_clock::now(); }
+  );
+  std::vector<sampler> samplers(threads_n);
+
+  result retval;
+  {
+    std::vector<std::jthread> threads;
+    for (std::size_t t{}; t != threads_n; ++t)
+      threads.emplace_back([&, t] {
+        auto& sample = samplers[t];
+        std::minstd_rand re{static_cast<std::minstd_rand::result_type>(t + 1)};
+        std::bernoulli_distribution push_it{cfg.push_ratio};
+        start.arrive_and_wait();
+        for (std::size_t n{}; n != cfg.ops; ++n)
+        {
+          if (push_it(re))
+            sample([&] { return q.try_push(value_type{}); });
+          else
+            sample([&] { return q.pop(); });
+        }
+      });
+
+    // the clock starts as the barrier releases every thread at once...
+    start.arrive_and_wait();
+    threads.clear();
+    retval.seconds =
+      std::chrono::duration<double>(bench_clock::now() - t0).count();
+  }
+
+  retval.ops = threads_n * cfg.ops;
+  for (auto& s : samplers)
+    retval.samples_ns.insert(retval.samples_ns.end(),
+      s.samples().begin(), s.samples().end());
+  return retval;
+}
+
+//=============================================================================
+
+void report(
+  std::string_view backend, std::size_t payload_bytes,
+  config const& cfg, result& r
+)
+{
+  auto const threads = cfg.scenario == "mixed"
+    ? cfg.producers : cfg.producers + cfg.consumers;
+  auto const producers = cfg.scenario == "mixed" ? 0 : cfg.producers;
+  auto const consumers = cfg.scenario == "mixed" ? 0 : cfg.consumers;
+  auto const p50 = percentile(r.samples_ns, 0.5);
+  auto const p99 = percentile(r.samples_ns, 0.99);
+  auto const p999 = percentile(r.samples_ns, 0.999);
+
+  if (json_output)
+  {
+    std::print("{}\n  {{\"backend\":\"{}\",\"scenario\":\"{}\","
+      "\"payload_bytes\":{},\"threads\":{},\"producers\":{},"
+      "\"consumers\":{},\"push_ratio\":{},\"batch\":{},\"ops\":{},"
+      "\"seconds\":{:.6f},\"ops_per_sec\":{:.0f},\"p50_ns\":{},"
+      "\"p99_ns\":{},\"p999_ns\":{}}}",
+      first_json_row ? "" : ",",
+      backend, cfg.scenario, payload_bytes, threads, producers, consumers,
+      cfg.push_ratio, cfg.batch, r.ops, r.seconds, r.ops / r.seconds,
+      p50, p99, p999);
+    first_json_row = false;
+  }
+  else
+    std::println("{},{},{},{},{},{},{},{},{},{:.6f},{:.0f},{},{},{}",
+      backend, cfg.scenario, payload_bytes, threads, producers, consumers,
+      cfg.push_ratio, cfg.batch, r.ops, r.seconds, r.ops / r.seconds,
+      p50, p99, p999);
+}
+
+struct sweep
+{
+  std::vector<std::pair<std::size_t, std::size_t>> producer_consumer;
+  std::vector<std::size_t> mixed_threads;
+  std::vector<double> push_ratios;
+  std::vector<std::size_t> batches;
+  std::size_t ops{};
+};
+
+template <template <typename> class Backend, typename T>
+void run_backend(sweep const& sw)
+{
+  using backend = Backend<T>;
+  using queue = typename backend::queue;
+  static_assert(basic_concurrent_queue_c<queue>);
+
+  // keep the bytes moved per run roughly constant across payload sizes...
+  auto const ops = std::max<std::size_t>(
+    1000, sw.ops / std::max<std::size_t>(1, sizeof(T) / 64)
+  );
+
+  for (auto const& [p, c] : sw.producer_consumer)
+  {
+    if (backend::single_producer_consumer && (p != 1 || c != 1))
+      continue;
+    for (auto const batch : sw.batches)
+    {
+      config const cfg{"pipeline", p, c, 0.5, batch, ops};
+      auto q = backend::make();
+      auto r = run_pipeline(*q, cfg);
+      report(backend::name, sizeof(T), cfg, r);
+    }
+  }
+
+  if constexpr (!backend::single_producer_consumer)
+  {
+    for (auto const t : sw.mixed_threads)
+      for (auto const ratio : sw.push_ratios)
+      {
+        config const cfg{"mixed", t, 0, ratio, 1, ops};
+        auto q = backend::make();
+        auto r = run_mixed(*q, cfg);
+        report(backend::name, sizeof(T), cfg, r);
+      }
+  }
+}
+
+template <typename T>
+void run_all_backends(sweep const& sw)
+{
+  run_backend<unbounded_backend, T>(sw);
+  run_backend<bounded_backend, T>(sw);
+  run_backend<pooled_backend, T>(sw);
+  run_backend<spsc_backend, T>(sw);
+  run_backend<mpmc_backend, T>(sw);
+  run_backend<sharded_backend, T>(sw);
+  run_backend<priority_backend, T>(sw);
+}
+
+int main(int argc, char* argv[])
+{
+  bool quick = false;
+  std::size_t ops = 200'000;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string_view const arg{argv[i]};
+    if (arg == "--quick")
+      quick = true;
+    else if (arg == "--json")
+      json_output = true;
+    else if (arg == "--ops" && i + 1 < argc)
+      ops = std::strtoull(argv[++i], nullptr, 10);
+    else
+    {
+      std::println(stderr, "Usage: {} [--quick] [--json] [--ops N]", argv[0]);
+      return 1;
+    }
+  }
+
+  auto const hw = std::max<std::size_t>(2, std::thread::hardware_concurrency());
+
+  sweep sw;
+  sw.ops = quick ? std::min<std::size_t>(ops, 20'000) : ops;
+  for (std::size_t n = 1; n <= hw / 2; n *= 2)
+  {
+    sw.producer_consumer.emplace_back(n, n);
+    sw.mixed_threads.push_back(2 * n);
+  }
+  if (hw > 2)
+  {
+    // fan-in and fan-out...
+    sw.producer_consumer.emplace_back(1, hw - 1);
+    sw.producer_consumer.emplace_back(hw - 1, 1);
+  }
+  sw.push_ratios = quick ? std::vector{0.5} : std::vector{0.25, 0.5, 0.75};
+  sw.batches = quick
+    ? std::vector<std::size_t>{1, 64}
+    : std::vector<std::size_t>{1, 16, 256};
+
+  if (json_output)
+    std::print("[");
+  else
+    std::println("backend,scenario,payload_bytes,threads,producers,consumers,"
+      "push_ratio,batch,ops,seconds,ops_per_sec,p50_ns,p99_ns,p999_ns");
+
+  run_all_backends<int>(sw);
+  run_all_backends<payload<64>>(sw);
+  if (!quick)
+    run_all_backends<payload<512>>(sw);
+  run_all_backends<payload<4096>>(sw);
+
+  if (json_output)
+    std::println("\n]");
+}
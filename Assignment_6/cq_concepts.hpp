@@ -3,10 +3,13 @@
 
 //============================================================================
 
+#include <chrono>
 #include <concepts>
 #include <format>
 #include <memory>
 #include <optional>
+#include <span>
+#include <stop_token>
 #include <tuple>
 #include <type_traits>
 
@@ -16,6 +19,50 @@ namespace comp3400_2026w {
 
 //=============================================================================
 
+// basic_concurrent_queue_c is the thread-safe push/pop surface shared by
+// all queue backends (i.e., including ones that are not built on a
+// std::queue and a mutex, which concurrent_queue_c requires)...
+template <typename T>
+concept basic_concurrent_queue_c =
+  requires
+  {
+    typename T::value_type;
+    typename T::size_type;
+
+    requires std::unsigned_integral<typename T::size_type>;
+  } &&
+  std::default_initializable<T> &&
+  std::destructible<T> &&
+
+  requires (
+    T t, T const ct,
+    typename T::value_type const& cv, typename T::value_type&& rv,
+    std::span<typename T::value_type const> cr
+  )
+  {
+    { ct.empty() } -> std::same_as<bool>;
+    { ct.size() } -> std::same_as<typename T::size_type>;
+
+    { t.push(cv) } -> std::same_as<void>;
+    { t.push(rv) } -> std::same_as<void>;
+    { t.try_push(cv) } -> std::same_as<bool>;
+    { t.try_push(rv) } -> std::same_as<bool>;
+
+    { t.pop() }
+      -> std::same_as<std::optional<typename T::value_type>>;
+    { t.try_pop() }
+      -> std::same_as<std::tuple<bool,std::optional<typename T::value_type>>>;
+
+    { t.push_range(cr) } -> std::same_as<void>;
+    { t.try_push_range(cr) } -> std::same_as<bool>;
+
+    { t.emplace(cv) } -> std::same_as<void>;
+    { t.try_emplace(rv) } -> std::same_as<bool>;
+  }
+;
+
+//=============================================================================
+
 template <typename T>
 concept concurrent_queue_c =
   requires (T ct, T t)
@@ -110,6 +157,105 @@ concept concurrent_queue_c =
 
 //=============================================================================
 
+template <typename T>
+concept blocking_concurrent_queue_c =
+  concurrent_queue_c<T> &&
+  requires (
+    T t, std::stop_token st,
+    std::chrono::milliseconds rel_time,
+    std::chrono::steady_clock::time_point abs_time
+  )
+  {
+    // NOTE: The blocking pops return std::nullopt only when they give up
+    //       waiting (i.e., timeout, stop requested, or closed and drained).
+    { t.wait_pop() } -> std::same_as<std::optional<typename T::value_type>>;
+    { t.wait_pop(st) } -> std::same_as<std::optional<typename T::value_type>>;
+    { t.wait_pop_for(rel_time) }
+      -> std::same_as<std::optional<typename T::value_type>>;
+    { t.wait_pop_until(abs_time) }
+      -> std::same_as<std::optional<typename T::value_type>>;
+  }
+;
+
+//=============================================================================
+
+template <typename T>
+concept bounded_concurrent_queue_c =
+  blocking_concurrent_queue_c<T> &&
+  requires (
+    T t, T const ct,
+    typename T::value_type const& cv, typename T::value_type&& rv,
+    std::chrono::milliseconds rel_time,
+    std::chrono::steady_clock::time_point abs_time
+  )
+  {
+    { ct.capacity() } -> std::same_as<typename T::size_type>;
+
+    { t.push_for(cv, rel_time) } -> std::same_as<bool>;
+    { t.push_for(rv, rel_time) } -> std::same_as<bool>;
+    { t.push_until(cv, abs_time) } -> std::same_as<bool>;
+    { t.push_until(rv, abs_time) } -> std::same_as<bool>;
+
+    { t.close() } -> std::same_as<void>;
+    { ct.is_closed() } -> std::same_as<bool>;
+  }
+;
+
+//=============================================================================
+
+// fixed_capacity_concurrent_queue_c is for the lock-free ring-buffer queues
+// (e.g., spsc_queue and mpmc_queue) whose capacity is fixed at compile
+// time...
+template <typename T>
+concept fixed_capacity_concurrent_queue_c =
+  basic_concurrent_queue_c<T> &&
+  requires
+  {
+    { T::capacity() } -> std::same_as<typename T::size_type>;
+  }
+;
+
+// spsc_concurrent_queue_c is for single-producer/single-consumer queues.
+// NOTE: The single producer and single consumer part is a semantic
+//       requirement that cannot be checked: at most one thread may push
+//       and at most one thread may pop at any time.
+template <typename T>
+concept spsc_concurrent_queue_c =
+  fixed_capacity_concurrent_queue_c<T>
+;
+
+//=============================================================================
+
+// priority_concurrent_queue_c is for queues that pop the highest priority
+// element (e.g., concurrent_priority_queue) instead of the oldest one...
+template <typename T>
+concept priority_concurrent_queue_c =
+  basic_concurrent_queue_c<T> &&
+  requires (
+    T t, T const ct, std::stop_token st,
+    std::chrono::milliseconds rel_time,
+    std::chrono::steady_clock::time_point abs_time
+  )
+  {
+    typename T::value_compare;
+
+    { ct.top() } -> std::same_as<std::optional<typename T::value_type>>;
+    { ct.value_comp() } -> std::same_as<typename T::value_compare>;
+
+    { t.wait_pop() } -> std::same_as<std::optional<typename T::value_type>>;
+    { t.wait_pop(st) } -> std::same_as<std::optional<typename T::value_type>>;
+    { t.wait_pop_for(rel_time) }
+      -> std::same_as<std::optional<typename T::value_type>>;
+    { t.wait_pop_until(abs_time) }
+      -> std::same_as<std::optional<typename T::value_type>>;
+
+    { t.close() } -> std::same_as<void>;
+    { ct.is_closed() } -> std::same_as<bool>;
+  }
+;
+
+//=============================================================================
+
 } // namespace comp3400_2026w
 
 //=============================================================================
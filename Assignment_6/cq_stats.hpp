@@ -0,0 +1,334 @@
+#ifndef include_cq_stats_hpp_
+#define include_cq_stats_hpp_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <mutex>
+
+namespace comp3400_2026w {
+
+//=============================================================================
+
+// concurrent_queue's third template argument is a statistics policy. The
+// default, no_queue_stats, has enabled == false: every hook is inside an
+// "if constexpr (Stats::enabled)" and the mutex is a plain std::mutex, so
+// it compiles away to nothing. queue_stats records:
+//
+//   * per-operation counters,
+//   * lock wait and lock hold time histograms (via instrumented_mutex),
+//   * the high-water depth, and,
+//   * enqueue-to-dequeue residence time histograms.
+//
+// and concurrent_queue::stats() returns a queue_stats_snapshot of them
+// (which is formattable).
+struct no_queue_stats
+{
+  static constexpr bool enabled = false;
+  using mutex_type = std::mutex;
+};
+
+//=============================================================================
+
+// latency_histogram counts durations in power-of-two nanosecond buckets:
+// bucket b holds durations d with std::bit_width(d) == b, i.e.,
+// [2^(b-1), 2^b) ns...
+class latency_histogram
+{
+public:
+  static constexpr std::size_t bucket_count = 65;
+
+  struct snapshot_type
+  {
+    std::array<std::uint64_t, bucket_count> buckets{};
+
+    std::uint64_t count() const noexcept
+    {
+      std::uint64_t retval{};
+      for (auto const n : buckets)
+        retval += n;
+      return retval;
+    }
+
+    // percentile() returns the upper bound of the bucket holding the p-th
+    // percentile (0 <= p <= 1), i.e., it is within a factor of two...
+    std::chrono::nanoseconds percentile(double p) const noexcept
+    {
+      auto const total = count();
+      if (total == 0)
+        return std::chrono::nanoseconds{0};
+
+      auto const rank =
+        std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p * total));
+      std::uint64_t seen{};
+      for (std::size_t b{}; b != bucket_count; ++b)
+      {
+        seen += buckets[b];
+        if (seen >= rank)
+          return b < 63
+            ? std::chrono::nanoseconds{(std::int64_t{1} << b) - 1}
+            : std::chrono::nanoseconds::max();
+      }
+      return std::chrono::nanoseconds::max();
+    }
+  };
+
+private:
+  std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+
+public:
+  template <typename Rep, typename Period>
+  void record(std::chrono::duration<Rep, Period> d) noexcept
+  {
+    auto const ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    auto const b = std::bit_width(static_cast<std::uint64_t>(ns < 0 ? 0 : ns));
+    buckets_[b].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  snapshot_type snapshot() const noexcept
+  {
+    snapshot_type retval;
+    for (std::size_t b{}; b != bucket_count; ++b)
+      retval.buckets[b] = buckets_[b].load(std::memory_order_relaxed);
+    return retval;
+  }
+};
+
+//=============================================================================
+
+// instrumented_mutex is a std::mutex that records how long lock() waited
+// and how long the lock was held. (It is BasicLockable and Lockable so it
+// works with std::lock_guard, std::scoped_lock, std::unique_lock and
+// std::condition_variable_any.)
+class instrumented_mutex
+{
+  using clock = std::chrono::steady_clock;
+
+  std::mutex m_;
+  clock::time_point acquired_{};  // only touched while m_ is held
+  latency_histogram wait_;
+  latency_histogram hold_;
+  std::atomic<std::uint64_t> try_lock_failures_{};
+
+public:
+  void lock()
+  {
+    auto const t0 = clock::now();
+    m_.lock();
+    acquired_ = clock::now();
+    wait_.record(acquired_ - t0);
+  }
+
+  bool try_lock()
+  {
+    if (!m_.try_lock())
+    {
+      try_lock_failures_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    acquired_ = clock::now();
+    return true;
+  }
+
+  void unlock()
+  {
+    auto const held = clock::now() - acquired_;
+    m_.unlock();
+    hold_.record(held);
+  }
+
+  latency_histogram const& wait_times() const noexcept
+  {
+    return wait_;
+  }
+
+  latency_histogram const& hold_times() const noexcept
+  {
+    return hold_;
+  }
+
+  std::uint64_t try_lock_failures() const noexcept
+  {
+    return try_lock_failures_.load(std::memory_order_relaxed);
+  }
+};
+
+//=============================================================================
+
+struct queue_stats_snapshot
+{
+  std::uint64_t pushed{};           // elements added
+  std::uint64_t popped{};           // elements removed
+  std::uint64_t try_lock_failures{};// try_*() that found the lock busy
+  std::uint64_t rejected_pushes{};  // try_push*() on a full/closed queue
+  std::uint64_t empty_pops{};       // pop()/try_pop() on an empty queue
+  std::uint64_t producer_waits{};   // pushes that blocked for room
+  std::uint64_t consumer_waits{};   // wait_pop*() that blocked for elements
+  std::uint64_t high_water{};       // largest size() seen after a push
+
+  latency_histogram::snapshot_type lock_wait;
+  latency_histogram::snapshot_type lock_hold;
+  latency_histogram::snapshot_type residence;
+};
+
+// queue_stats' hooks are called with the queue's mutex held, except for
+// the lock histograms and try-lock failures which instrumented_mutex
+// records itself...
+class queue_stats
+{
+  using clock = std::chrono::steady_clock;
+
+  std::atomic<std::uint64_t> pushed_{};
+  std::atomic<std::uint64_t> popped_{};
+  std::atomic<std::uint64_t> rejected_pushes_{};
+  std::atomic<std::uint64_t> empty_pops_{};
+  std::atomic<std::uint64_t> producer_waits_{};
+  std::atomic<std::uint64_t> consumer_waits_{};
+  std::atomic<std::uint64_t> high_water_{};
+  latency_histogram residence_;
+
+  // one enqueue time per queued element, in queue order...
+  std::deque<clock::time_point> enqueued_at_;
+
+  static void add(std::atomic<std::uint64_t>& a, std::uint64_t n) noexcept
+  {
+    a.fetch_add(n, std::memory_order_relaxed);
+  }
+
+public:
+  static constexpr bool enabled = true;
+  using mutex_type = instrumented_mutex;
+
+  void on_push(std::size_t n, std::size_t new_size)
+  {
+    add(pushed_, n);
+    enqueued_at_.insert(enqueued_at_.end(), n, clock::now());
+    if (new_size > high_water_.load(std::memory_order_relaxed))
+      high_water_.store(new_size, std::memory_order_relaxed);
+  }
+
+  void on_pop(std::size_t n)
+  {
+    add(popped_, n);
+    auto const now = clock::now();
+    n = std::min(n, enqueued_at_.size());
+    for (std::size_t i{}; i != n; ++i)
+    {
+      residence_.record(now - enqueued_at_.front());
+      enqueued_at_.pop_front();
+    }
+  }
+
+  // the contents were replaced wholesale (e.g., assignment) so the
+  // residence clock of every element restarts now...
+  void on_reset(std::size_t new_size)
+  {
+    enqueued_at_.assign(new_size, clock::now());
+    if (new_size > high_water_.load(std::memory_order_relaxed))
+      high_water_.store(new_size, std::memory_order_relaxed);
+  }
+
+  void on_rejected_push() noexcept { add(rejected_pushes_, 1); }
+  void on_empty_pop() noexcept { add(empty_pops_, 1); }
+  void on_producer_wait() noexcept { add(producer_waits_, 1); }
+  void on_consumer_wait() noexcept { add(consumer_waits_, 1); }
+
+  queue_stats_snapshot snapshot(mutex_type const& m) const
+  {
+    auto const get = [](std::atomic<std::uint64_t> const& a) {
+      return a.load(std::memory_order_relaxed);
+    };
+
+    queue_stats_snapshot retval;
+    retval.pushed = get(pushed_);
+    retval.popped = get(popped_);
+    retval.try_lock_failures = m.try_lock_failures();
+    retval.rejected_pushes = get(rejected_pushes_);
+    retval.empty_pops = get(empty_pops_);
+    retval.producer_waits = get(producer_waits_);
+    retval.consumer_waits = get(consumer_waits_);
+    retval.high_water = get(high_water_);
+    retval.lock_wait = m.wait_times().snapshot();
+    retval.lock_hold = m.hold_times().snapshot();
+    retval.residence = residence_.snapshot();
+    return retval;
+  }
+};
+
+//=============================================================================
+
+} // namespace comp3400_2026w
+
+//=============================================================================
+
+namespace std {
+
+// formats as n=COUNT p50=... p99=... p99.9=... (each an upper bound)...
+template <typename Ch>
+struct formatter<comp3400_2026w::latency_histogram::snapshot_type, Ch>
+{
+  constexpr auto parse(std::basic_format_parse_context<Ch>& ctx)
+  {
+    auto it = ctx.begin();
+    if (it != ctx.end() && *it != '}')
+      throw std::format_error("invalid format specifier for histogram");
+    return it;
+  }
+
+  template <typename FormatContext>
+  auto format(
+    comp3400_2026w::latency_histogram::snapshot_type const& h,
+    FormatContext& ctx
+  ) const
+  {
+    return std::format_to(
+      ctx.out(), "n={} p50<={}ns p99<={}ns p99.9<={}ns",
+      h.count(),
+      h.percentile(0.5).count(),
+      h.percentile(0.99).count(),
+      h.percentile(0.999).count()
+    );
+  }
+};
+
+template <typename Ch>
+struct formatter<comp3400_2026w::queue_stats_snapshot, Ch>
+{
+  constexpr auto parse(std::basic_format_parse_context<Ch>& ctx)
+  {
+    auto it = ctx.begin();
+    if (it != ctx.end() && *it != '}')
+      throw std::format_error("invalid format specifier for queue_stats");
+    return it;
+  }
+
+  template <typename FormatContext>
+  auto format(
+    comp3400_2026w::queue_stats_snapshot const& s,
+    FormatContext& ctx
+  ) const
+  {
+    return std::format_to(
+      ctx.out(),
+      "pushed={} popped={} try_lock_failures={} rejected_pushes={} "
+      "empty_pops={} producer_waits={} consumer_waits={} high_water={} "
+      "lock_wait[{}] lock_hold[{}] residence[{}]",
+      s.pushed, s.popped, s.try_lock_failures, s.rejected_pushes,
+      s.empty_pops, s.producer_waits, s.consumer_waits, s.high_water,
+      s.lock_wait, s.lock_hold, s.residence
+    );
+  }
+};
+
+} // namespace std
+
+//=============================================================================
+
+#endif // include_cq_stats_hpp_
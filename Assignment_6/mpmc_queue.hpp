@@ -0,0 +1,294 @@
+#ifndef include_mpmc_queue_hpp_
+#define include_mpmc_queue_hpp_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "concurrent_queue.hpp"
+
+namespace comp3400_2026w {
+
+// mpmc_queue is a lock-free, fixed-capacity multi-producer/multi-consumer
+// queue (D. Vyukov's bounded MPMC design). Every slot carries a sequence
+// number that says whose turn it is:
+//
+//   seq == pos      the slot is free for the producer claiming pos
+//   seq == pos + 1  the slot holds the element for the consumer claiming pos
+//
+// where pos is an (unmasked) enqueue or dequeue position. Producers and
+// consumers claim positions with a CAS on enqueue_pos_ / dequeue_pos_ and
+// then publish by storing the next sequence number into the slot, so no
+// operation ever takes a lock.
+//
+// The return conventions follow concurrent_queue: try_push() returns false
+// and try_pop() returns {false, std::nullopt} when they lose a race with
+// another thread (i.e., the lock-free version of "the lock was busy"),
+// push() spins (yielding) while the queue is full, and pop() returns
+// std::nullopt only when the queue is empty.
+template <typename T, std::size_t Capacity = 1024>
+requires (Capacity > 1 && (Capacity & (Capacity - 1)) == 0)
+class mpmc_queue
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+private:
+  using difference_type = std::make_signed_t<size_type>;
+
+  static constexpr size_type mask_ = Capacity - 1;
+
+  struct slot
+  {
+    std::atomic<size_type> seq;
+    alignas(T) std::byte storage[sizeof(T)];
+
+    T* element() noexcept
+    {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+  enum class attempt { done, blocked, contended };
+
+  std::unique_ptr<slot[]> slots_{make_slots()};
+
+  alignas(cache_line_size) std::atomic<size_type> enqueue_pos_{};
+  alignas(cache_line_size) std::atomic<size_type> dequeue_pos_{};
+
+  static std::unique_ptr<slot[]> make_slots()
+  {
+    auto retval{std::make_unique<slot[]>(Capacity)};
+    for (size_type i{}; i != Capacity; ++i)
+      retval[i].seq.store(i, std::memory_order_relaxed);
+    return retval;
+  }
+
+  static difference_type distance(size_type a, size_type b) noexcept
+  {
+    return static_cast<difference_type>(a - b);
+  }
+
+  // blocked means full...
+  template <typename... Args>
+  attempt try_emplace_once(Args&&... args)
+  {
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    slot& s = slots_[pos & mask_];
+    auto const dif = distance(s.seq.load(std::memory_order_acquire), pos);
+
+    if (dif < 0)
+      return attempt::blocked;
+    if (dif > 0 ||
+        !enqueue_pos_.compare_exchange_weak(
+          pos, pos + 1, std::memory_order_relaxed
+        ))
+      return attempt::contended;
+
+    std::construct_at(s.element(), std::forward<Args>(args)...);
+    s.seq.store(pos + 1, std::memory_order_release);
+    return attempt::done;
+  }
+
+  // blocked means empty...
+  attempt try_pop_once(std::optional<value_type>& out)
+  {
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    slot& s = slots_[pos & mask_];
+    auto const dif = distance(s.seq.load(std::memory_order_acquire), pos + 1);
+
+    if (dif < 0)
+      return attempt::blocked;
+    if (dif > 0 ||
+        !dequeue_pos_.compare_exchange_weak(
+          pos, pos + 1, std::memory_order_relaxed
+        ))
+      return attempt::contended;
+
+    T* const p = s.element();
+    out.emplace(std::move(*p));
+    std::destroy_at(p);
+    s.seq.store(pos + Capacity, std::memory_order_release);
+    return attempt::done;
+  }
+
+public:
+  mpmc_queue() = default;
+
+  mpmc_queue(mpmc_queue const&) = delete;
+  mpmc_queue& operator=(mpmc_queue const&) = delete;
+
+  ~mpmc_queue()
+  {
+    clear();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  size_type size() const noexcept
+  {
+    // the positions are advanced with relaxed CASes so the two loads are
+    // not ordered with each other: tail can be seen behind head (with the
+    // queue empty) or, after more pushes and pops in between, more than
+    // Capacity ahead. Clamp the result to [0, Capacity], i.e., it is only a
+    // snapshot (as with any concurrent size())...
+    auto const head = dequeue_pos_.load(std::memory_order_relaxed);
+    auto const tail = enqueue_pos_.load(std::memory_order_relaxed);
+    return tail > head ? std::min<size_type>(tail - head, Capacity) : 0;
+  }
+
+  void clear()
+  {
+    while (pop())
+      ;
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    return try_emplace_once(std::forward<Args>(args)...) == attempt::done;
+  }
+
+  // emplace() and push() retry on contention and yield while full...
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    for (;;)
+    {
+      // NOTE: args are only consumed once an attempt succeeds.
+      switch (try_emplace_once(std::forward<Args>(args)...))
+      {
+        case attempt::done:
+          return;
+        case attempt::blocked:
+          std::this_thread::yield();
+          break;
+        case attempt::contended:
+          break;
+      }
+    }
+  }
+
+  void push(value_type const& v)
+  {
+    emplace(v);
+  }
+
+  void push(value_type&& v)
+  {
+    emplace(std::move(v));
+  }
+
+  bool try_push(value_type const& v)
+  {
+    return try_emplace(v);
+  }
+
+  bool try_push(value_type&& v)
+  {
+    return try_emplace(std::move(v));
+  }
+
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  void push_range(R&& r)
+  {
+    for (auto&& x : r)
+      emplace(std::forward<decltype(x)>(x));
+  }
+
+  // try_push_range() claims n consecutive positions with a single CAS, so
+  // it is all-or-nothing: it fails if the range does not fit or if another
+  // producer got in first. (Single-pass ranges are first materialized, so
+  // their elements are consumed even on failure.)
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  bool try_push_range(R&& r)
+  {
+    if constexpr (!std::ranges::forward_range<R>)
+    {
+      std::vector<value_type> tmp;
+      for (auto&& x : r)
+        tmp.emplace_back(std::forward<decltype(x)>(x));
+      return try_push_range(std::move(tmp));
+    }
+    else
+    {
+      auto const n = static_cast<size_type>(std::ranges::distance(r));
+      if (n == 0)
+        return true;
+      if (n > Capacity)
+        return false;
+
+      // a slot that is free for this lap stays free until its position is
+      // claimed, so checking them all before the CAS is enough...
+      auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+      for (size_type i{}; i != n; ++i)
+      {
+        auto const seq =
+          slots_[(pos + i) & mask_].seq.load(std::memory_order_acquire);
+        if (seq != pos + i)
+          return false;
+      }
+      if (!enqueue_pos_.compare_exchange_strong(
+            pos, pos + n, std::memory_order_relaxed
+          ))
+        return false;
+
+      for (auto&& x : r)
+      {
+        slot& s = slots_[pos & mask_];
+        std::construct_at(s.element(), std::forward<decltype(x)>(x));
+        s.seq.store(pos + 1, std::memory_order_release);
+        ++pos;
+      }
+      return true;
+    }
+  }
+
+  std::optional<value_type> pop()
+  {
+    std::optional<value_type> retval;
+    for (;;)
+    {
+      switch (try_pop_once(retval))
+      {
+        case attempt::done:
+        case attempt::blocked:
+          return retval;
+        case attempt::contended:
+          break;
+      }
+    }
+  }
+
+  auto try_pop() -> std::tuple<bool, std::optional<value_type>>
+  {
+    std::optional<value_type> retval;
+    if (try_pop_once(retval) == attempt::contended)
+      return {false, std::nullopt};
+    return {true, std::move(retval)};
+  }
+};
+
+} // namespace comp3400_2026w
+
+#endif // include_mpmc_queue_hpp_
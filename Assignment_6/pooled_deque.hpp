@@ -0,0 +1,506 @@
+#ifndef include_pooled_deque_hpp_
+#define include_pooled_deque_hpp_
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace comp3400_2026w {
+
+// the default block holds about 4 KiB of elements (but at least 16)...
+template <typename T>
+inline constexpr std::size_t pooled_deque_block_size =
+  std::max<std::size_t>(16, 4096 / sizeof(T));
+
+// pooled_deque is a FIFO sequence container (i.e., it has the subset of
+// std::deque that std::queue and concurrent_queue use) made of fixed-size
+// blocks. A block emptied by pop_front() is kept on a per-container free
+// list and is reused by push_back() so, once the queue has reached its
+// steady-state depth, pushing and popping do no heap allocations at all.
+// (With concurrent_queue this keeps malloc out of the critical section.)
+//
+// Blocks and elements are allocated through Allocator, e.g., a
+// std::pmr::polymorphic_allocator to draw the blocks from a pool resource.
+// shrink_to_fit() gives the free blocks back to the allocator.
+template <
+  typename T,
+  std::size_t BlockSize = pooled_deque_block_size<T>,
+  typename Allocator = std::allocator<T>
+>
+requires (BlockSize > 0)
+class pooled_deque
+{
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+
+  static constexpr size_type block_size = BlockSize;
+
+private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  struct block
+  {
+    block* next{};
+    alignas(T) std::byte storage[BlockSize * sizeof(T)];
+
+    T* at(size_type i) noexcept
+    {
+      return std::launder(reinterpret_cast<T*>(storage) + i);
+    }
+  };
+
+  using block_allocator =
+    typename alloc_traits::template rebind_alloc<block>;
+  using block_traits = std::allocator_traits<block_allocator>;
+
+  [[no_unique_address]] Allocator alloc_;
+
+  // the elements are [head_index_ of head_, tail_index_ of tail_) where
+  // head_ == tail_ whenever the container is empty...
+  block* head_{};
+  block* tail_{};
+  size_type head_index_{};
+  size_type tail_index_{};
+  size_type size_{};
+
+  // blocks emptied by pop_front() that are waiting to be reused...
+  block* free_{};
+  size_type free_count_{};
+
+  block* acquire_block()
+  {
+    if (free_)
+    {
+      auto* const b = free_;
+      free_ = b->next;
+      --free_count_;
+      b->next = nullptr;
+      return b;
+    }
+
+    block_allocator ba{alloc_};
+    auto* const b = std::to_address(block_traits::allocate(ba, 1));
+    return std::construct_at(b);
+  }
+
+  void recycle_block(block* b) noexcept
+  {
+    b->next = free_;
+    free_ = b;
+    ++free_count_;
+  }
+
+  void deallocate_list(block* b) noexcept
+  {
+    block_allocator ba{alloc_};
+    while (b)
+    {
+      auto* const next = b->next;
+      std::destroy_at(b);
+      block_traits::deallocate(ba, b, 1);
+      b = next;
+    }
+  }
+
+  void release_all() noexcept
+  {
+    clear();
+    deallocate_list(head_);
+    deallocate_list(free_);
+    head_ = tail_ = free_ = nullptr;
+    head_index_ = tail_index_ = free_count_ = 0;
+  }
+
+  void steal(pooled_deque& other) noexcept
+  {
+    head_ = std::exchange(other.head_, nullptr);
+    tail_ = std::exchange(other.tail_, nullptr);
+    head_index_ = std::exchange(other.head_index_, 0);
+    tail_index_ = std::exchange(other.tail_index_, 0);
+    size_ = std::exchange(other.size_, 0);
+    free_ = std::exchange(other.free_, nullptr);
+    free_count_ = std::exchange(other.free_count_, 0);
+  }
+
+  template <bool Const>
+  class basic_iterator
+  {
+    friend class pooled_deque;
+
+    block* b_{};
+    size_type i_{};
+
+    basic_iterator(block* b, size_type i) noexcept :
+      b_{b},
+      i_{i}
+    {
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, T const&, T&>;
+    using pointer = std::conditional_t<Const, T const*, T*>;
+
+    basic_iterator() = default;
+
+    // iterator converts to const_iterator...
+    operator basic_iterator<true>() const noexcept
+    requires (!Const)
+    {
+      return {b_, i_};
+    }
+
+    reference operator*() const noexcept
+    {
+      return *b_->at(i_);
+    }
+
+    pointer operator->() const noexcept
+    {
+      return b_->at(i_);
+    }
+
+    // only the tail block can be full and have no successor so stepping
+    // off its end lands on end()...
+    basic_iterator& operator++() noexcept
+    {
+      if (++i_ == BlockSize && b_->next)
+      {
+        b_ = b_->next;
+        i_ = 0;
+      }
+      return *this;
+    }
+
+    basic_iterator operator++(int) noexcept
+    {
+      auto retval{*this};
+      ++*this;
+      return retval;
+    }
+
+    friend bool operator==(
+      basic_iterator const&, basic_iterator const&
+    ) = default;
+  };
+
+public:
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  pooled_deque() noexcept(noexcept(Allocator())) = default;
+
+  explicit pooled_deque(Allocator const& a) noexcept :
+    alloc_{a}
+  {
+  }
+
+  template <typename InputIt>
+  requires std::input_iterator<InputIt>
+  pooled_deque(InputIt first, InputIt last, Allocator const& a = Allocator()) :
+    alloc_{a}
+  {
+    try
+    {
+      for (; first != last; ++first)
+        emplace_back(*first);
+    }
+    catch (...)
+    {
+      release_all();
+      throw;
+    }
+  }
+
+  template <typename R>
+  requires std::ranges::input_range<R>
+  pooled_deque(std::from_range_t, R&& r, Allocator const& a = Allocator()) :
+    pooled_deque(std::ranges::begin(r), std::ranges::end(r), a)
+  {
+  }
+
+  pooled_deque(pooled_deque const& other) :
+    pooled_deque(
+      other.begin(), other.end(),
+      alloc_traits::select_on_container_copy_construction(other.alloc_)
+    )
+  {
+  }
+
+  pooled_deque(pooled_deque const& other, Allocator const& a) :
+    pooled_deque(other.begin(), other.end(), a)
+  {
+  }
+
+  pooled_deque(pooled_deque&& other) noexcept :
+    alloc_{std::move(other.alloc_)}
+  {
+    steal(other);
+  }
+
+  pooled_deque(pooled_deque&& other, Allocator const& a) :
+    alloc_{a}
+  {
+    if (alloc_ == other.alloc_)
+      steal(other);
+    else
+    {
+      try
+      {
+        for (auto& x : other)
+          emplace_back(std::move(x));
+      }
+      catch (...)
+      {
+        release_all();
+        throw;
+      }
+    }
+  }
+
+  ~pooled_deque()
+  {
+    release_all();
+  }
+
+  pooled_deque& operator=(pooled_deque const& other)
+  {
+    if (this != std::addressof(other))
+    {
+      if constexpr (
+        alloc_traits::propagate_on_container_copy_assignment::value
+      )
+      {
+        if (alloc_ != other.alloc_)
+          release_all();
+        alloc_ = other.alloc_;
+      }
+
+      // copy into a temporary with our allocator so that, if a copy
+      // throws, *this is unchanged...
+      pooled_deque tmp(other, alloc_);
+      clear();
+      for (auto& x : tmp)
+        emplace_back(std::move(x));
+    }
+    return *this;
+  }
+
+  pooled_deque& operator=(pooled_deque&& other)
+    noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value
+    )
+  {
+    if (this == std::addressof(other))
+      return *this;
+
+    if constexpr (
+      alloc_traits::propagate_on_container_move_assignment::value
+    )
+    {
+      release_all();
+      alloc_ = std::move(other.alloc_);
+      steal(other);
+    }
+    else
+    {
+      if (alloc_ == other.alloc_)
+      {
+        release_all();
+        steal(other);
+      }
+      else
+      {
+        // a different allocator cannot free other's blocks so the elements
+        // are moved instead (and our own blocks reused)...
+        clear();
+        for (auto& x : other)
+          emplace_back(std::move(x));
+        other.clear();
+      }
+    }
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept
+  {
+    return alloc_;
+  }
+
+  iterator begin() noexcept { return {head_, head_index_}; }
+  iterator end() noexcept { return {tail_, tail_index_}; }
+  const_iterator begin() const noexcept { return {head_, head_index_}; }
+  const_iterator end() const noexcept { return {tail_, tail_index_}; }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  size_type size() const noexcept
+  {
+    return size_;
+  }
+
+  // the number of blocks held on the free list...
+  size_type free_blocks() const noexcept
+  {
+    return free_count_;
+  }
+
+  reference front() noexcept { return *head_->at(head_index_); }
+  const_reference front() const noexcept { return *head_->at(head_index_); }
+  reference back() noexcept { return *tail_->at(tail_index_ - 1); }
+  const_reference back() const noexcept { return *tail_->at(tail_index_ - 1); }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args)
+  {
+    if (!tail_)
+    {
+      head_ = tail_ = acquire_block();
+      head_index_ = tail_index_ = 0;
+    }
+
+    if (tail_index_ == BlockSize)
+    {
+      // construct into the new block before linking it in so a throwing
+      // constructor leaves *this unchanged...
+      auto* const b = acquire_block();
+      try
+      {
+        alloc_traits::construct(alloc_, b->at(0), std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        recycle_block(b);
+        throw;
+      }
+      tail_->next = b;
+      tail_ = b;
+      tail_index_ = 1;
+    }
+    else
+    {
+      alloc_traits::construct(
+        alloc_, tail_->at(tail_index_), std::forward<Args>(args)...
+      );
+      ++tail_index_;
+    }
+
+    ++size_;
+    return back();
+  }
+
+  void push_back(value_type const& v)
+  {
+    emplace_back(v);
+  }
+
+  void push_back(value_type&& v)
+  {
+    emplace_back(std::move(v));
+  }
+
+  template <typename R>
+  requires std::ranges::input_range<R>
+  void append_range(R&& r)
+  {
+    for (auto&& x : r)
+      emplace_back(std::forward<decltype(x)>(x));
+  }
+
+  void pop_front() noexcept
+  {
+    alloc_traits::destroy(alloc_, head_->at(head_index_));
+    ++head_index_;
+    --size_;
+
+    if (size_ == 0)
+    {
+      // rewind to the start of the (only) block...
+      head_index_ = tail_index_ = 0;
+    }
+    else if (head_index_ == BlockSize)
+    {
+      auto* const b = head_;
+      head_ = head_->next;
+      head_index_ = 0;
+      recycle_block(b);
+    }
+  }
+
+  // destroys every element but keeps all blocks for reuse...
+  void clear() noexcept
+  {
+    while (size_ != 0)
+      pop_front();
+  }
+
+  // returns the free blocks to the allocator...
+  void shrink_to_fit() noexcept
+  {
+    deallocate_list(free_);
+    free_ = nullptr;
+    free_count_ = 0;
+  }
+
+  void swap(pooled_deque& other)
+    noexcept(
+      alloc_traits::propagate_on_container_swap::value ||
+      alloc_traits::is_always_equal::value
+    )
+  {
+    using std::swap;
+    if constexpr (alloc_traits::propagate_on_container_swap::value)
+      swap(alloc_, other.alloc_);
+    // (as with the standard containers, swapping unequal allocators that do
+    // not propagate is undefined behaviour)...
+    swap(head_, other.head_);
+    swap(tail_, other.tail_);
+    swap(head_index_, other.head_index_);
+    swap(tail_index_, other.tail_index_);
+    swap(size_, other.size_);
+    swap(free_, other.free_);
+    swap(free_count_, other.free_count_);
+  }
+
+  friend void swap(pooled_deque& a, pooled_deque& b)
+    noexcept(noexcept(a.swap(b)))
+  {
+    a.swap(b);
+  }
+
+  friend bool operator==(pooled_deque const& a, pooled_deque const& b)
+  requires std::equality_comparable<T>
+  {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+  }
+
+  friend auto operator<=>(pooled_deque const& a, pooled_deque const& b)
+  requires std::three_way_comparable<T>
+  {
+    return std::lexicographical_compare_three_way(
+      a.begin(), a.end(), b.begin(), b.end()
+    );
+  }
+};
+
+} // namespace comp3400_2026w
+
+#endif // include_pooled_deque_hpp_
@@ -0,0 +1,237 @@
+#ifndef include_sharded_concurrent_queue_hpp_
+#define include_sharded_concurrent_queue_hpp_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "cache_line.hpp"
+#include "concurrent_queue.hpp"
+
+namespace comp3400_2026w {
+
+// shard_order selects the ordering guarantee of sharded_concurrent_queue:
+//
+//   relaxed       pushes are spread round-robin over the lanes, so there
+//                 is no ordering guarantee between any two elements
+//   per_producer  each thread always pushes to its own home lane, so the
+//                 elements pushed by one thread are popped in FIFO order
+enum class shard_order { relaxed, per_producer };
+
+// sharded_concurrent_queue spreads its elements over Lanes independent
+// concurrent_queue lanes (each on its own cache line) so threads contend
+// on Lanes mutexes instead of one. Every thread has a home lane: pops start
+// there and then steal from the other lanes. try_pop()/try_push() only
+// try-lock each lane, while pop()/push() fall back to locking one.
+//
+// It satisfies basic_concurrent_queue_c (see cq_concepts.hpp) but is not a
+// concurrent_queue_c since it has no single underlying std::queue, and
+// front()/back() have no meaning without a global order.
+template <
+  typename T,
+  std::size_t Lanes = 8,
+  shard_order Order = shard_order::relaxed,
+  typename Container = std::deque<T>
+>
+requires (Lanes > 0)
+class sharded_concurrent_queue
+{
+public:
+  using lane_type = concurrent_queue<T, Container>;
+  using value_type = typename lane_type::value_type;
+  using size_type = typename lane_type::size_type;
+
+  static constexpr size_type lane_count = Lanes;
+
+private:
+  struct alignas(cache_line_size) lane
+  {
+    lane_type q;
+  };
+
+  std::array<lane, Lanes> lanes_;
+
+  static inline std::atomic<size_type> next_home_lane_{};
+
+  // threads are handed home lanes in round-robin order on first use...
+  static size_type home_lane() noexcept
+  {
+    thread_local size_type const home =
+      next_home_lane_.fetch_add(1, std::memory_order_relaxed) % Lanes;
+    return home;
+  }
+
+  // the lane the next push by this thread should go to (a per-thread
+  // counter, so choosing a lane does not itself become a contended
+  // atomic)...
+  static size_type push_lane() noexcept
+  {
+    if constexpr (Order == shard_order::per_producer)
+      return home_lane();
+    else
+    {
+      thread_local size_type next = home_lane();
+      return next++ % Lanes;
+    }
+  }
+
+  lane_type& lane_at(size_type start, size_type i) noexcept
+  {
+    return lanes_[(start + i) % Lanes].q;
+  }
+
+  // per_producer order may only use the home lane; relaxed order tries
+  // every lane starting with first...
+  template <typename F>
+  bool try_each_push_lane(size_type first, F&& try_push_to)
+  {
+    if constexpr (Order == shard_order::per_producer)
+      return try_push_to(lane_at(first, 0));
+    else
+    {
+      for (size_type i{}; i != Lanes; ++i)
+        if (try_push_to(lane_at(first, i)))
+          return true;
+      return false;
+    }
+  }
+
+public:
+  sharded_concurrent_queue() = default;
+
+  sharded_concurrent_queue(sharded_concurrent_queue const&) = delete;
+  sharded_concurrent_queue& operator=(sharded_concurrent_queue const&) =
+    delete;
+
+  void clear()
+  {
+    for (auto& l : lanes_)
+      l.q.clear();
+  }
+
+  // empty() and size() read each lane's wait-free size in turn (i.e., no
+  // lane is locked) so they are only a snapshot when other threads are
+  // pushing or popping...
+  bool empty() const noexcept
+  {
+    for (auto const& l : lanes_)
+      if (!l.q.empty())
+        return false;
+    return true;
+  }
+
+  size_type size() const noexcept
+  {
+    size_type retval{};
+    for (auto const& l : lanes_)
+      retval += l.q.size();
+    return retval;
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    // NOTE: try_emplace() only consumes args when it succeeds.
+    return try_each_push_lane(push_lane(), [&](lane_type& q) {
+      return q.try_emplace(std::forward<Args>(args)...);
+    });
+  }
+
+  // a relaxed emplace()/push() first tries to find an uncontended lane
+  // before blocking on the lane it picked...
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    auto const first = push_lane();
+    if constexpr (Order == shard_order::relaxed)
+    {
+      for (size_type i{}; i != Lanes; ++i)
+        if (lane_at(first, i).try_emplace(std::forward<Args>(args)...))
+          return;
+    }
+    lane_at(first, 0).emplace(std::forward<Args>(args)...);
+  }
+
+  void push(value_type const& v)
+  {
+    emplace(v);
+  }
+
+  void push(value_type&& v)
+  {
+    emplace(std::move(v));
+  }
+
+  bool try_push(value_type const& v)
+  {
+    return try_emplace(v);
+  }
+
+  bool try_push(value_type&& v)
+  {
+    return try_emplace(std::move(v));
+  }
+
+  // a range is pushed into a single lane under one lock...
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  void push_range(R&& r)
+  {
+    lane_at(push_lane(), 0).push_range(std::forward<R>(r));
+  }
+
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  bool try_push_range(R&& r)
+  {
+    // NOTE: A failed try_push_range() does not consume a forward range.
+    return try_each_push_lane(push_lane(), [&](lane_type& q) {
+      return q.try_push_range(std::forward<R>(r));
+    });
+  }
+
+  // pop() returns std::nullopt only if every lane was found empty...
+  std::optional<value_type> pop()
+  {
+    auto const home = home_lane();
+
+    // first pass: steal from whichever lane is not busy...
+    for (size_type i{}; i != Lanes; ++i)
+    {
+      auto [acquired, v] = lane_at(home, i).try_pop();
+      if (v)
+        return std::move(v);
+    }
+
+    // second pass: wait for each lane's lock in turn...
+    for (size_type i{}; i != Lanes; ++i)
+      if (auto v = lane_at(home, i).pop())
+        return v;
+
+    return std::nullopt;
+  }
+
+  // try_pop() returns {false, std::nullopt} if it found no element and at
+  // least one lane was busy, i.e., it could not tell the queue is empty...
+  auto try_pop() -> std::tuple<bool, std::optional<value_type>>
+  {
+    auto const home = home_lane();
+    bool all_acquired = true;
+    for (size_type i{}; i != Lanes; ++i)
+    {
+      auto [acquired, v] = lane_at(home, i).try_pop();
+      if (v)
+        return {true, std::move(v)};
+      all_acquired = all_acquired && acquired;
+    }
+    return {all_acquired, std::nullopt};
+  }
+};
+
+} // namespace comp3400_2026w
+
+#endif // include_sharded_concurrent_queue_hpp_
@@ -0,0 +1,217 @@
+#ifndef include_spsc_queue_hpp_
+#define include_spsc_queue_hpp_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "concurrent_queue.hpp"
+
+namespace comp3400_2026w {
+
+// spsc_queue is a lock-free, fixed-capacity ring buffer for exactly ONE
+// producer thread and ONE consumer thread. push*()/emplace*() may only be
+// called by the producer; pop()/try_pop()/clear() only by the consumer.
+// empty() and size() may be called from any thread (but are only a
+// snapshot). It satisfies spsc_concurrent_queue_c (see cq_concepts.hpp).
+//
+// head_ and tail_ grow without bound and are masked on use, so full
+// (tail - head == Capacity) and empty (tail == head) are distinguishable.
+// Each side also keeps a cached copy of the other side's index so that it
+// only touches the other side's cache line when the cached value says the
+// queue looks full (producer) or empty (consumer).
+template <typename T, std::size_t Capacity = 1024>
+requires (Capacity > 0 && (Capacity & (Capacity - 1)) == 0)
+class spsc_queue
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+private:
+  static constexpr size_type mask_ = Capacity - 1;
+
+  struct slot
+  {
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  std::unique_ptr<slot[]> slots_{std::make_unique<slot[]>(Capacity)};
+
+  // written by the consumer...
+  alignas(cache_line_size) std::atomic<size_type> head_{};
+  size_type cached_tail_{};
+
+  // written by the producer...
+  alignas(cache_line_size) std::atomic<size_type> tail_{};
+  size_type cached_head_{};
+
+  T* element(size_type i) noexcept
+  {
+    return std::launder(reinterpret_cast<T*>(slots_[i & mask_].storage));
+  }
+
+  // must only be called by the producer: only reloads head_ when the
+  // cached copy says there is not enough room...
+  bool has_room(size_type n = 1) noexcept
+  {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (Capacity - (tail - cached_head_) >= n)
+      return true;
+    cached_head_ = head_.load(std::memory_order_acquire);
+    return Capacity - (tail - cached_head_) >= n;
+  }
+
+  // must only be called by the producer after checking there is room...
+  template <typename... Args>
+  void emplace_unchecked(Args&&... args)
+  {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    std::construct_at(element(tail), std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+public:
+  spsc_queue() = default;
+
+  spsc_queue(spsc_queue const&) = delete;
+  spsc_queue& operator=(spsc_queue const&) = delete;
+
+  ~spsc_queue()
+  {
+    clear();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  size_type size() const noexcept
+  {
+    // load head_ first: tail_ can only have grown by the time it is read...
+    auto const head = head_.load(std::memory_order_acquire);
+    auto const tail = tail_.load(std::memory_order_acquire);
+    return tail - head;
+  }
+
+  void clear()
+  {
+    while (pop())
+      ;
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    if (!has_room())
+      return false;
+    emplace_unchecked(std::forward<Args>(args)...);
+    return true;
+  }
+
+  // emplace() and push() spin (yielding) while the ring is full...
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    while (!has_room())
+      std::this_thread::yield();
+    emplace_unchecked(std::forward<Args>(args)...);
+  }
+
+  void push(value_type const& v)
+  {
+    emplace(v);
+  }
+
+  void push(value_type&& v)
+  {
+    emplace(std::move(v));
+  }
+
+  bool try_push(value_type const& v)
+  {
+    return try_emplace(v);
+  }
+
+  bool try_push(value_type&& v)
+  {
+    return try_emplace(std::move(v));
+  }
+
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  void push_range(R&& r)
+  {
+    for (auto&& x : r)
+      emplace(std::forward<decltype(x)>(x));
+  }
+
+  // try_push_range() is all-or-nothing: it fails unless the entire range
+  // fits. (Single-pass ranges are first materialized, so their elements
+  // are consumed even on failure.)
+  template <typename R>
+  requires compatible_input_range_c<R, value_type>
+  bool try_push_range(R&& r)
+  {
+    if constexpr (!std::ranges::forward_range<R>)
+    {
+      std::vector<value_type> tmp;
+      for (auto&& x : r)
+        tmp.emplace_back(std::forward<decltype(x)>(x));
+      return try_push_range(std::move(tmp));
+    }
+    else
+    {
+      auto const n = static_cast<size_type>(std::ranges::distance(r));
+      if (!has_room(n))
+        return false;
+
+      // only the consumer runs concurrently and it can only make room...
+      for (auto&& x : r)
+        emplace_unchecked(std::forward<decltype(x)>(x));
+      return true;
+    }
+  }
+
+  std::optional<value_type> pop()
+  {
+    auto const head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_)
+    {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_)
+        return std::nullopt;
+    }
+
+    T* const p = element(head);
+    std::optional<value_type> retval{std::move(*p)};
+    std::destroy_at(p);
+    head_.store(head + 1, std::memory_order_release);
+    return retval;
+  }
+
+  // with a single consumer there is never contention, so try_pop() always
+  // "acquires" the queue...
+  auto try_pop() -> std::tuple<bool, std::optional<value_type>>
+  {
+    return {true, pop()};
+  }
+};
+
+} // namespace comp3400_2026w
+
+#endif // include_spsc_queue_hpp_
@@ -0,0 +1,215 @@
+#ifndef include_thread_pool_hpp_
+#define include_thread_pool_hpp_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "concurrent_queue.hpp"
+#include "work_stealing_deque.hpp"
+
+namespace comp3400_2026w {
+
+// thread_pool is a work-stealing executor:
+//
+//   * each worker owns a work_stealing_deque: tasks posted from inside a
+//     worker go to its own deque and it runs them LIFO,
+//   * tasks posted from other threads go to a global injection
+//     concurrent_queue,
+//   * an idle worker looks in its own deque, then the injection queue, and
+//     then steals (FIFO) from the other workers starting at a random one,
+//   * a worker that finds nothing parks on an atomic wait (i.e., it does
+//     not spin) and posting only wakes one when a worker is parked.
+//
+// post() is the lightweight fire-and-forget submission: an exception
+// escaping a posted task terminates the program (just like a std::jthread
+// function). submit() wraps the task in a std::packaged_task and returns
+// its std::future (so exceptions are delivered through the future).
+//
+// The destructor runs all tasks already posted (including any they post)
+// before joining the workers.
+class thread_pool
+{
+public:
+  using task_type = std::move_only_function<void()>;
+  using size_type = std::size_t;
+
+private:
+  struct worker
+  {
+    work_stealing_deque<task_type*> local;
+  };
+
+  std::vector<std::unique_ptr<worker>> workers_;
+  concurrent_queue<task_type*> injection_;
+
+  alignas(cache_line_size) std::atomic<std::uint32_t> wake_epoch_{};
+  std::atomic<size_type> sleeping_{};
+  std::atomic<bool> stopping_{};
+
+  // declared last so the threads are joined before anything above goes...
+  std::vector<std::jthread> threads_;
+
+  static inline thread_local thread_pool* current_pool_{};
+  static inline thread_local size_type current_index_{};
+
+  static void run(task_type* t)
+  {
+    std::unique_ptr<task_type> const owner{t};
+    (*owner)();
+  }
+
+  task_type* find_task(size_type index, std::minstd_rand& rng)
+  {
+    if (auto t = workers_[index]->local.pop())
+      return *t;
+
+    if (auto t = injection_.pop())
+      return *t;
+
+    auto const n = workers_.size();
+    auto const first = static_cast<size_type>(rng()) % n;
+    for (size_type i{}; i != n; ++i)
+    {
+      auto const victim = (first + i) % n;
+      if (victim == index)
+        continue;
+      if (auto t = workers_[victim]->local.steal())
+        return *t;
+    }
+    return nullptr;
+  }
+
+  void run_worker(size_type index)
+  {
+    current_pool_ = this;
+    current_index_ = index;
+    std::minstd_rand rng{static_cast<std::minstd_rand::result_type>(index + 1)};
+
+    for (;;)
+    {
+      if (auto* t = find_task(index, rng))
+      {
+        run(t);
+        continue;
+      }
+
+      // announce we are about to sleep and then look once more so a task
+      // posted in between is not missed (see wake_one())...
+      auto const epoch = wake_epoch_.load(std::memory_order_acquire);
+      sleeping_.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if (auto* t = find_task(index, rng))
+      {
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        run(t);
+        continue;
+      }
+
+      if (stopping_.load(std::memory_order_acquire))
+      {
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        return;
+      }
+
+      wake_epoch_.wait(epoch, std::memory_order_acquire);
+      sleeping_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  void wake_one()
+  {
+    // pairs with the fence in run_worker(): either the parking worker sees
+    // the new task or we see it is (about to be) asleep...
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) == 0)
+      return;
+    wake_epoch_.fetch_add(1, std::memory_order_release);
+    wake_epoch_.notify_one();
+  }
+
+public:
+  explicit thread_pool(
+    size_type worker_count = std::max(1u, std::thread::hardware_concurrency())
+  )
+  {
+    worker_count = std::max<size_type>(1, worker_count);
+
+    // all deques must exist before any worker can try to steal...
+    workers_.reserve(worker_count);
+    for (size_type i{}; i != worker_count; ++i)
+      workers_.push_back(std::make_unique<worker>());
+
+    threads_.reserve(worker_count);
+    for (size_type i{}; i != worker_count; ++i)
+      threads_.emplace_back([this, i] { run_worker(i); });
+  }
+
+  thread_pool(thread_pool const&) = delete;
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  ~thread_pool()
+  {
+    stopping_.store(true, std::memory_order_seq_cst);
+    wake_epoch_.fetch_add(1, std::memory_order_release);
+    wake_epoch_.notify_all();
+    threads_.clear();
+
+    // nothing should be left but never leak a task...
+    while (auto t = injection_.pop())
+      delete *t;
+    for (auto& w : workers_)
+      while (auto t = w->local.pop())
+        delete *t;
+  }
+
+  size_type size() const noexcept
+  {
+    return workers_.size();
+  }
+
+  template <typename F>
+  requires std::invocable<std::decay_t<F>&>
+  void post(F&& f)
+  {
+    auto* const t = new task_type{std::forward<F>(f)};
+    if (current_pool_ == this)
+      workers_[current_index_]->local.push(t);
+    else
+      injection_.push(t);
+    wake_one();
+  }
+
+  template <typename F, typename... Args>
+  requires std::invocable<std::decay_t<F>, std::decay_t<Args>...>
+  auto submit(F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>
+  {
+    using result_type =
+      std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+    std::packaged_task<result_type()> task{
+      [f = std::forward<F>(f), ...args = std::forward<Args>(args)]() mutable {
+        return std::invoke(std::move(f), std::move(args)...);
+      }
+    };
+    auto retval{task.get_future()};
+    post(std::move(task));
+    return retval;
+  }
+};
+
+} // namespace comp3400_2026w
+
+#endif // include_thread_pool_hpp_
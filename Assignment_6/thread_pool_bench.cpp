@@ -0,0 +1,148 @@
+// thread_pool_bench: task throughput of thread_pool versus the a06-soln.cpp
+// style of std::jthread workers sharing one concurrent_queue.
+//
+// Usage: thread_pool_bench.exe [TASKS]
+//
+// Outputs CSV (to std::cout) with the columns:
+//   executor,workload,workers,tasks,seconds,tasks_per_sec
+//
+// Workloads:
+//   external  the main thread posts every task
+//   fanout    one root task recursively posts two children per level
+//             (i.e., most tasks are posted from inside the workers)
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <latch>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include "concurrent_queue.hpp"
+#include "thread_pool.hpp"
+
+using comp3400_2026w::concurrent_queue;
+using comp3400_2026w::thread_pool;
+
+// shared_fifo_pool is the baseline: N workers blocked in wait_pop() on a
+// single shared concurrent_queue...
+class shared_fifo_pool
+{
+  concurrent_queue<std::move_only_function<void()>> tasks_;
+  std::vector<std::jthread> threads_;
+
+public:
+  explicit shared_fifo_pool(std::size_t n)
+  {
+    for (std::size_t i{}; i != n; ++i)
+      threads_.emplace_back([this] {
+        while (auto t = tasks_.wait_pop())
+          (*t)();
+      });
+  }
+
+  ~shared_fifo_pool()
+  {
+    tasks_.close();
+  }
+
+  template <typename F>
+  void post(F&& f)
+  {
+    tasks_.push(std::forward<F>(f));
+  }
+};
+
+// a trivially small amount of work so the executor overhead dominates...
+std::atomic<std::size_t> sink;
+
+template <typename Pool>
+void spawn(Pool& pool, unsigned depth, std::latch& done)
+{
+  if (depth == 0)
+  {
+    sink.fetch_add(1, std::memory_order_relaxed);
+    done.count_down();
+    return;
+  }
+  pool.post([&pool, depth, &done] { spawn(pool, depth - 1, done); });
+  pool.post([&pool, depth, &done] { spawn(pool, depth - 1, done); });
+}
+
+template <typename Pool>
+double run_external(std::size_t workers, std::size_t tasks)
+{
+  std::latch done(static_cast<std::ptrdiff_t>(tasks));
+  Pool pool(workers);
+
+  auto const t0{std::chrono::steady_clock::now()};
+  for (std::size_t i{}; i != tasks; ++i)
+    pool.post([&done] {
+      sink.fetch_add(1, std::memory_order_relaxed);
+      done.count_down();
+    });
+  done.wait();
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - t0
+  ).count();
+}
+
+template <typename Pool>
+double run_fanout(std::size_t workers, unsigned depth)
+{
+  std::latch done(std::ptrdiff_t{1} << depth);
+  Pool pool(workers);
+
+  auto const t0{std::chrono::steady_clock::now()};
+  pool.post([&pool, depth, &done] { spawn(pool, depth, done); });
+  done.wait();
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - t0
+  ).count();
+}
+
+void report(
+  char const* executor, char const* workload,
+  std::size_t workers, std::size_t tasks, double seconds
+)
+{
+  std::println(
+    "{},{},{},{},{:.6f},{:.0f}",
+    executor, workload, workers, tasks, seconds, tasks / seconds
+  );
+}
+
+int main(int argc, char* argv[])
+{
+  std::size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+  if (tasks == 0)
+    tasks = 1;
+
+  // fanout runs 2^depth leaf tasks (plus 2^depth - 1 interior ones)...
+  unsigned depth{};
+  while ((std::size_t{2} << depth) <= tasks)
+    ++depth;
+
+  std::vector<std::size_t> worker_counts;
+  auto const hw = std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t n = 1; n < hw; n *= 2)
+    worker_counts.push_back(n);
+  worker_counts.push_back(hw);
+
+  std::println("executor,workload,workers,tasks,seconds,tasks_per_sec");
+  for (auto const n : worker_counts)
+  {
+    report("shared_fifo", "external", n, tasks,
+      run_external<shared_fifo_pool>(n, tasks));
+    report("work_stealing", "external", n, tasks,
+      run_external<thread_pool>(n, tasks));
+
+    auto const fanout_tasks = (std::size_t{2} << depth) - 1;
+    report("shared_fifo", "fanout", n, fanout_tasks,
+      run_fanout<shared_fifo_pool>(n, depth));
+    report("work_stealing", "fanout", n, fanout_tasks,
+      run_fanout<thread_pool>(n, depth));
+  }
+}
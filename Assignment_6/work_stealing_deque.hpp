@@ -0,0 +1,167 @@
+#ifndef include_work_stealing_deque_hpp_
+#define include_work_stealing_deque_hpp_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "cache_line.hpp"
+
+namespace comp3400_2026w {
+
+// work_stealing_deque is a Chase-Lev deque (using the C11 memory orderings
+// of Le, Pop, Cohen & Zappa Nardelli, "Correct and Efficient Work-Stealing
+// for Weak Memory Models", PPoPP 2013). The owning thread push()es and
+// pop()s at the bottom (i.e., LIFO, which keeps its working set hot) while
+// any other thread may steal() from the top (i.e., the oldest element).
+//
+// The buffer grows when full. Retired buffers are kept until destruction
+// since a concurrent thief may still be reading one.
+//
+// T must be trivially copyable (e.g., a pointer) since the elements are
+// stored in atomics.
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+class work_stealing_deque
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+private:
+  using index_type = std::int64_t;
+
+  struct buffer
+  {
+    index_type capacity;
+    std::unique_ptr<std::atomic<T>[]> slots;
+
+    explicit buffer(index_type cap) :
+      capacity{cap},
+      slots{std::make_unique<std::atomic<T>[]>(static_cast<size_type>(cap))}
+    {
+    }
+
+    std::atomic<T>& at(index_type i) noexcept
+    {
+      return slots[static_cast<size_type>(i & (capacity - 1))];
+    }
+  };
+
+  alignas(cache_line_size) std::atomic<index_type> top_{};
+  alignas(cache_line_size) std::atomic<index_type> bottom_{};
+  std::atomic<buffer*> buffer_;
+
+  // owner-only: the current buffer and every buffer it replaced...
+  std::vector<std::unique_ptr<buffer>> buffers_;
+
+  buffer* grow(buffer* old, index_type bottom, index_type top)
+  {
+    auto bigger{std::make_unique<buffer>(old->capacity * 2)};
+    for (index_type i = top; i != bottom; ++i)
+      bigger->at(i).store(
+        old->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed
+      );
+
+    auto* const retval = bigger.get();
+    buffers_.push_back(std::move(bigger));
+    buffer_.store(retval, std::memory_order_release);
+    return retval;
+  }
+
+public:
+  explicit work_stealing_deque(size_type initial_capacity = 256)
+  {
+    // round the capacity up to a power of two so indices can be masked...
+    index_type cap = 1;
+    while (static_cast<size_type>(cap) < initial_capacity)
+      cap *= 2;
+    buffers_.push_back(std::make_unique<buffer>(cap));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+
+  work_stealing_deque(work_stealing_deque const&) = delete;
+  work_stealing_deque& operator=(work_stealing_deque const&) = delete;
+
+  // size() and empty() are only a snapshot when called concurrently...
+  size_type size() const noexcept
+  {
+    auto const b = bottom_.load(std::memory_order_relaxed);
+    auto const t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_type>(b - t) : 0;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  // owner only...
+  void push(T v)
+  {
+    auto const b = bottom_.load(std::memory_order_relaxed);
+    auto const t = top_.load(std::memory_order_acquire);
+    auto* buf = buffer_.load(std::memory_order_relaxed);
+    if (b - t > buf->capacity - 1)
+      buf = grow(buf, b, t);
+
+    buf->at(b).store(v, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // owner only...
+  std::optional<T> pop()
+  {
+    auto const b = bottom_.load(std::memory_order_relaxed) - 1;
+    auto* const buf = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+      // it was empty...
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+
+    std::optional<T> retval{buf->at(b).load(std::memory_order_relaxed)};
+    if (t == b)
+    {
+      // the last element: race any thief for it...
+      if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+          ))
+        retval.reset();
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return retval;
+  }
+
+  // any thread: returns std::nullopt if empty or if it lost a race...
+  std::optional<T> steal()
+  {
+    auto t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const b = bottom_.load(std::memory_order_acquire);
+    if (t >= b)
+      return std::nullopt;
+
+    auto* const buf = buffer_.load(std::memory_order_acquire);
+    T const v = buf->at(t).load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        ))
+      return std::nullopt;
+    return v;
+  }
+};
+
+} // namespace comp3400_2026w
+
+#endif // include_work_stealing_deque_hpp_